@@ -1,78 +1,67 @@
 const net = require('net');
+const v8 = require('v8');
 
-const { Loot, SetErrorLanguageEN, SetLogLevel } = require('./build/Release/node-loot');
+const { createHandler } = require('./handler');
+const { FRAME_HEADER_SIZE, FrameDecoder, SHM_SIZE, SHM_THRESHOLD, SharedRing,
+        encodeFrame, encodeRawFrame, encodeTypedArrays, ipcPath, shmName, writeFrame } = require('./ipc');
 
-process.on('uncaughtException', error => {
-  console.error(error.message);
-  process.exit(1);
-});
-
-const CHUNK_SIZE = 32 * 1024;
-
-let currentLogLevel = 2; // default: info (matches previous hardcoded filter)
+// everything depending on the environment (the addon, the connection) is set up in here, the code
+// above may be evaluated ahead of time into a startup snapshot (see build-snapshot.js)
+function main() {
+  process.on('uncaughtException', error => {
+    console.error(error.message);
+    process.exit(1);
+  });
 
-const client = net.connect(`\\\\?\\pipe\\loot-ipc-${process.argv[2]}`, (arg) => {
-  let instance;
-  let dataBuffer = '';
+  const { SharedRegion } = require('./build/Release/node-loot');
 
-  function send(args) {
-    const message = JSON.stringify(args) + '\uFFFF';
-    // Chunk large messages to avoid Windows named pipe size limits
-    for (let i = 0; i < message.length; i += CHUNK_SIZE) {
-      client.write(message.slice(i, i + CHUNK_SIZE));
-    }
+  // shared memory set up by the host for large messages. Everything goes through the pipe if that doesn't exist
+  let ring;
+  try {
+    ring = new SharedRing(new SharedRegion(shmName(process.argv[2]), SHM_SIZE, false));
+  } catch (err) {
+    ring = undefined;
   }
 
-  function handleEvent(event) {
-    let result;
-    try {
-      if (event.type === 'init') {
-        SetErrorLanguageEN();
-        instance = new Loot(...event.args, logCallback);
-      } else if (event.type === 'setLogLevel') {
-        currentLogLevel = event.args[0];
-        SetLogLevel(event.args[0]);
-      } else if (event.type === 'terminate') {
-        send({});
-        process.exit(0);
+  const client = net.connect(ipcPath(process.argv[2]), (arg) => {
+    function send(args) {
+      let frame;
+      if (args.rawResult !== undefined) {
+        frame = encodeRawFrame(args.id, args.rawResult);
       } else {
-        if (event.type === 'loadPlugins') {
-          SetLogLevel(4); // suppress BSA hash collision warnings during plugin loading
-          result = instance[event.type](...event.args);
-          SetLogLevel(currentLogLevel);
-        } else {
-          result = instance[event.type](...event.args);
+        if (args.result !== undefined) {
+          args.result = encodeTypedArrays(args.result);
         }
+        frame = encodeFrame(args);
       }
-      send({ result });
-    } catch (error) {
-      send({ error: error.message, extraArgs: JSON.stringify(error) });
+      if ((ring !== undefined) && (frame.length >= SHM_THRESHOLD)) {
+        const payload = frame.subarray(FRAME_HEADER_SIZE);
+        const position = ring.tryWrite(payload);
+        if (position !== undefined) {
+          writeFrame(client, encodeFrame({ shm: [position, payload.length] }));
+          return;
+        }
+      }
+      writeFrame(client, frame);
     }
-  }
 
-  function logCallback(level, message) {
-    if (level >= currentLogLevel) {
-      send({ log: { level, message } });
-    }
-  }
+    const handleRequest = createHandler(send, () => process.exit(0), true);
 
-  client.on('data', buffer => {
-    dataBuffer += buffer.toString();
-    const messages = dataBuffer.split('\uFFFF');
-    // Keep incomplete chunk (last element after split if no trailing delimiter)
-    if (!dataBuffer.endsWith('\uFFFF')) {
-      dataBuffer = messages.pop();
-    } else {
-      dataBuffer = '';
-    }
-    // Process each complete message
-    for (const msg of messages) {
-      if (msg.length > 0) {
-        handleEvent(JSON.parse(msg));
-      }
-    }
+    const decoder = new FrameDecoder(frame => {
+      handleRequest(JSON.parse(frame.toString()));
+    });
+
+    client.on('data', buffer => {
+      decoder.push(buffer);
+    });
+
+    // signal readiness to process messages
+    send({ ready: true });
   });
+}
 
-  // signal readiness to process messages
-  send({ result: null });
-});
+if ((v8.startupSnapshot !== undefined) && v8.startupSnapshot.isBuildingSnapshot()) {
+  v8.startupSnapshot.setDeserializeMainFunction(main);
+} else {
+  main();
+}
@@ -0,0 +1,58 @@
+/**
+ * measures how long it takes from spawning a remote process until it's ready to accept requests,
+ * with and without the startup snapshot (run build-snapshot.js first).
+ * Usage: node bench/time-to-ready.js [iterations]
+ */
+const { ProcessTransport, defaultFork, generateId, snapshotArgs } = require('../transport');
+
+const iterations = parseInt(process.argv[2] || '20', 10);
+
+function timeToReady(useSnapshot) {
+  return new Promise((resolve, reject) => {
+    const onFork = (script, args, execArgv) => defaultFork(script, args, useSnapshot ? execArgv : []);
+    let start;
+    const transport = new ProcessTransport(generateId(), onFork, {
+      onMessage: msg => {
+        if (msg.ready) {
+          const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+          transport.send({ id: 1, type: 'terminate' }, () => undefined);
+          setTimeout(() => {
+            transport.close();
+            resolve(elapsed);
+          }, 50);
+        }
+      },
+      onDisconnect: () => undefined,
+      onError: () => undefined,
+    });
+    transport.open(err => {
+      if (err !== null) {
+        return reject(err);
+      }
+      start = process.hrtime.bigint();
+      transport.spawn();
+    });
+  });
+}
+
+async function measure(label, useSnapshot) {
+  const times = [];
+  for (let i = 0; i < iterations; ++i) {
+    times.push(await timeToReady(useSnapshot));
+  }
+  times.sort((lhs, rhs) => lhs - rhs);
+  const median = times[Math.floor(times.length / 2)];
+  const mean = times.reduce((sum, time) => sum + time, 0) / times.length;
+  console.log(`${label}: median ${median.toFixed(1)}ms, mean ${mean.toFixed(1)}ms, min ${times[0].toFixed(1)}ms`);
+}
+
+async function main() {
+  await measure('regular', false);
+  if (snapshotArgs().length === 0) {
+    console.log('snapshot: not available, run "node build-snapshot.js"');
+  } else {
+    await measure('snapshot', true);
+  }
+}
+
+main();
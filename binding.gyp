@@ -8,12 +8,41 @@
             "sources": [
                 "src/lootwrapper.cpp",
                 "src/lootwrapper.h",
+                "src/condition_paths.cpp",
+                "src/condition_paths.h",
+                "src/converters.cpp",
+                "src/converters.h",
                 "src/exceptions.cpp",
                 "src/exceptions.h",
                 "src/string_cast.cpp",
                 "src/string_cast.h",
+                "src/file_hash.cpp",
+                "src/file_hash.h",
+                "src/json_encoder.cpp",
+                "src/json_encoder.h",
+                "src/loaded_lists.cpp",
+                "src/loaded_lists.h",
+                "src/log_queue.cpp",
+                "src/log_queue.h",
+                "src/metadata_cache.cpp",
+                "src/metadata_cache.h",
+                "src/metadata_handle.cpp",
+                "src/metadata_handle.h",
                 "src/napi_helpers.cpp",
                 "src/napi_helpers.h",
+                "src/plugin_fingerprints.cpp",
+                "src/plugin_fingerprints.h",
+                "src/property_keys.cpp",
+                "src/property_keys.h",
+                "src/addon_data.h",
+                "src/shared_region.cpp",
+                "src/shared_region.h",
+                "src/snapshot.cpp",
+                "src/snapshot.h",
+                "src/sort_cache.cpp",
+                "src/sort_cache.h",
+                "src/thread_pool.cpp",
+                "src/thread_pool.h",
                 "src/util.cpp",
                 "src/util.h"
             ],
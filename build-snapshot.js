@@ -0,0 +1,63 @@
+/**
+ * builds a V8 startup snapshot of the remote process (async.js) so that it doesn't have to load and
+ * compile its modules every time it's started. Used by the default fork function when it exists and
+ * was built by the same node binary.
+ * Usage: node build-snapshot.js
+ * Requires node 18.20 or later, electron doesn't support user land snapshots
+ */
+const cp = require('child_process');
+const fs = require('fs');
+const path = require('path');
+
+const { SNAPSHOT_PATH, snapshotInfo } = require('./transport');
+
+// modules that are part of the snapshot, in the order they are required
+const MODULES = ['./ipc', './handler', './async'];
+
+/**
+ * the snapshot entry point has to be a single script that only requires builtin modules.
+ * The modules are wrapped like node does it, the native addon is loaded at runtime from the directory
+ * of the script path the remote is started with
+ */
+function bundle() {
+  const parts = [`'use strict';
+const builtinRequire = require;
+const definitions = {};
+const loaded = {};
+function bundledRequire(name) {
+  if (name.startsWith('./build/')) {
+    return builtinRequire('module').createRequire(process.argv[1])(name);
+  }
+  if (definitions[name] === undefined) {
+    return builtinRequire(name);
+  }
+  if (loaded[name] === undefined) {
+    const module = { exports: {} };
+    loaded[name] = module;
+    definitions[name](module, module.exports, bundledRequire);
+  }
+  return loaded[name].exports;
+}
+`];
+  MODULES.forEach(name => {
+    const source = fs.readFileSync(path.join(__dirname, `${name}.js`), { encoding: 'utf8' });
+    parts.push(`definitions['${name}'] = function (module, exports, require) {\n${source}\n};\n`);
+  });
+  parts.push(`bundledRequire('${MODULES[MODULES.length - 1]}');\n`);
+  return parts.join('\n');
+}
+
+function build() {
+  const bundlePath = `${SNAPSHOT_PATH}.js`;
+  fs.writeFileSync(bundlePath, bundle());
+  try {
+    cp.execFileSync(process.execPath, ['--snapshot-blob', SNAPSHOT_PATH, '--build-snapshot', bundlePath],
+                    { stdio: 'inherit' });
+  } finally {
+    fs.unlinkSync(bundlePath);
+  }
+  // the snapshot can only be used by the exact binary that created it
+  fs.writeFileSync(`${SNAPSHOT_PATH}.json`, JSON.stringify(snapshotInfo()));
+}
+
+build();
@@ -0,0 +1,63 @@
+// functions that don't change the state of the game handle, identical calls give identical results
+const READ_ONLY_FUNCTIONS = new Set([
+  'getMasterlistRevision',
+  'getPlugin',
+  'getPluginsSnapshot',
+  'getPluginMetadata',
+  'getPluginsMetadata',
+  'sortPlugins',
+  'getLoadOrder',
+  'isPluginActive',
+  'getGroups',
+  'getGroupsPath',
+  'getUserGroups',
+  'getGeneralMessages',
+]);
+
+/**
+ * lets a read-only request that is identical (same function, arguments and priority) to one still in flight
+ * share that one's response instead of being sent again. All callers receive the same result object.
+ * Any other request ends this, a request made after it has to see its effect
+ */
+class Coalescer {
+  constructor() {
+    // callbacks waiting for the response, by request
+    this.inflight = new Map();
+  }
+
+  /**
+   * send is called with the message and the callback for its response unless the request could join
+   * one in flight
+   */
+  run(message, callback, send) {
+    if (!READ_ONLY_FUNCTIONS.has(message.type)) {
+      this.inflight.clear();
+      return send(message, callback);
+    }
+
+    const key = `${message.priority}:${message.type}:${JSON.stringify(message.args)}`;
+    const waiting = this.inflight.get(key);
+    if (waiting !== undefined) {
+      waiting.push(callback);
+      return;
+    }
+
+    const callbacks = [callback];
+    this.inflight.set(key, callbacks);
+    send(message, (err, result) => {
+      if (this.inflight.get(key) === callbacks) {
+        this.inflight.delete(key);
+      }
+      callbacks.forEach(cb => {
+        if (cb !== undefined) {
+          cb(err, result);
+        }
+      });
+    });
+  }
+}
+
+module.exports = {
+  Coalescer,
+  READ_ONLY_FUNCTIONS,
+};
@@ -0,0 +1,177 @@
+const { RemoteDied, errorFromResponse } = require('./errors');
+
+/**
+ * request/response handling on top of a transport: requests get an id and are sent right away
+ * (or once the remote is ready), responses are matched to the callbacks by that id
+ */
+class Connection {
+  /**
+   * onLog is called with (level, message, session) for log messages from the remote
+   */
+  constructor(onLog) {
+    // requests that were sent (or are waiting to be sent) and haven't been answered yet, by id
+    this.pending = new Map();
+    // requests made while the remote process isn't ready yet
+    this.backlog = [];
+    this.nextId = 1;
+    this.ready = false;
+    this.onLog = onLog;
+    this.handlers = {
+      onMessage: msg => this.handleResponse(msg),
+      onDisconnect: err => {
+        this.ready = false;
+        // before failing the requests so that their callbacks see the new state
+        if (this.onDisconnect !== undefined) {
+          this.onDisconnect();
+        }
+        this.failPending(((err === undefined) || (err.code === 'EPIPE') || (err.code === 'ECONNRESET'))
+          ? new RemoteDied()
+          : err);
+      },
+      onError: message => this.onLog(4, message),
+    };
+  }
+
+  /**
+   * use a transport that hasn't been started yet
+   */
+  open(transport, callback) {
+    this.transport = transport;
+    this.transport.setHandlers(this.handlers);
+    this.transport.open(callback);
+  }
+
+  /**
+   * use a transport whose remote is already running and ready to handle requests
+   */
+  adopt(transport) {
+    this.transport = transport;
+    this.transport.setHandlers(this.handlers);
+    this.ready = true;
+  }
+
+  /**
+   * start the remote, requests made so far are sent once it's ready
+   */
+  start() {
+    this.ready = false;
+    this.transport.spawn();
+  }
+
+  /**
+   * start a new remote. firstRequests ([{ message, callback }]) are handled by it before anything else
+   */
+  restart(firstRequests = []) {
+    // requests sent to the previous process won't be answered anymore
+    this.failPending(new RemoteDied());
+    this.start();
+    this.backlog.unshift(...firstRequests.map(({ message, callback }) => this.register(message, callback)));
+  }
+
+  request(message, callback) {
+    const request = this.register(message, callback);
+    if (this.ready) {
+      this.deliver(request);
+    } else {
+      this.backlog.push(request);
+    }
+  }
+
+  // number of requests that haven't been answered yet
+  get pendingCount() {
+    return this.pending.size;
+  }
+
+  close() {
+    this.transport.close();
+  }
+
+  // assign an id to the message so the response can be matched to the callback
+  register(message, callback) {
+    const id = this.nextId++;
+    this.pending.set(id, callback !== undefined ? callback : () => undefined);
+    return { id, ...message };
+  }
+
+  /**
+   * requests are sent right away, without waiting for previous responses.
+   * The remote process handles them in the order they were sent
+   */
+  deliver(request) {
+    const handleError = err => {
+      if (!!err) {
+        this.settle(request.id, (err.code === 'EPIPE') ? new RemoteDied() : err);
+      }
+    };
+    try {
+      this.transport.send(request, handleError);
+    } catch (err) {
+      handleError(err);
+    }
+  }
+
+  settle(id, err, result) {
+    const callback = this.pending.get(id);
+    if (callback !== undefined) {
+      this.pending.delete(id);
+      callback(err, result);
+      this.checkIdle();
+    }
+  }
+
+  failPending(err) {
+    const callbacks = Array.from(this.pending.values());
+    this.pending.clear();
+    this.backlog = [];
+    callbacks.forEach(callback => callback(err));
+    this.checkIdle();
+  }
+
+  /**
+   * call the callback once all requests made so far are answered
+   */
+  whenIdle(callback) {
+    this.idleCallback = callback;
+    this.checkIdle();
+  }
+
+  checkIdle() {
+    if ((this.pending.size === 0) && (this.idleCallback !== undefined)) {
+      const callback = this.idleCallback;
+      this.idleCallback = undefined;
+      callback();
+    }
+  }
+
+  handleResponse(msg) {
+    if (msg.log) {
+      this.onLog(msg.log.level, msg.log.message, msg.session);
+      return;
+    }
+
+    if (msg.stats) {
+      if (this.onStats !== undefined) {
+        this.onStats(msg.stats);
+      }
+      return;
+    }
+
+    if (msg.ready) {
+      this.ready = true;
+      const backlog = this.backlog;
+      this.backlog = [];
+      backlog.forEach(request => this.deliver(request));
+      return;
+    }
+
+    if (msg.error) {
+      this.settle(msg.id, errorFromResponse(msg));
+    } else {
+      this.settle(msg.id, null, msg.result);
+    }
+  }
+}
+
+module.exports = {
+  Connection,
+};
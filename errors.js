@@ -0,0 +1,70 @@
+// interface IPluginsNotLoadedArgs {
+//   name: string;
+//   plugin: string;
+//   func: string;
+//   currentlyLoaded: string[];
+// }
+class PluginNotLoaded extends Error {
+  constructor(args) {
+    super(`Plugin not loaded: "${args.plugin}"; currently loaded: ${args.currentlyLoaded.join(', ')}`);
+    Error.captureStackTrace(this, this.constructor);
+    this.name = this.constructor.name;
+    this.plugin = args.plugin;
+    this.func = args.func;
+    this.currentlyLoaded = args.currentlyLoaded || [];
+  }
+}
+
+class AlreadyClosed extends Error {
+  constructor() {
+    super('Already closed');
+    Error.captureStackTrace(this, this.constructor);
+
+    this.name = this.constructor.name;
+  }
+}
+
+class RemoteDied extends Error {
+  constructor() {
+    super('LOOT process died');
+    Error.captureStackTrace(this, this.constructor);
+
+    this.name = this.constructor.name;
+  }
+}
+
+class Superseded extends Error {
+  constructor() {
+    super('Superseded by a newer request');
+    Error.captureStackTrace(this, this.constructor);
+
+    this.name = this.constructor.name;
+  }
+}
+
+/**
+ * recreate the error reported by the remote
+ */
+function errorFromResponse(msg) {
+  const extraArgs = JSON.parse(msg.extraArgs);
+  let err;
+  if (extraArgs.name === 'AlreadyClosed') {
+    err = new AlreadyClosed();
+  } else if (extraArgs.name === 'Superseded') {
+    err = new Superseded();
+  } else if (extraArgs.name === 'PluginNotLoaded') {
+    err = new PluginNotLoaded(extraArgs);
+  } else {
+    err = new Error(msg.error);
+  }
+  Object.assign(err, extraArgs);
+  return err;
+}
+
+module.exports = {
+  AlreadyClosed,
+  PluginNotLoaded,
+  RemoteDied,
+  Superseded,
+  errorFromResponse,
+};
@@ -0,0 +1,262 @@
+const { encodeTypedArrays } = require('./ipc');
+
+/**
+ * result that was already encoded to json (utf-8 in a Buffer) natively. Empty for undefined
+ */
+class EncodedResult {
+  constructor(json) {
+    this.json = json;
+  }
+}
+
+/**
+ * fifo queue that doesn't have to move all remaining elements when taking one from the front
+ */
+class RequestQueue {
+  constructor() {
+    this.items = [];
+    this.head = 0;
+  }
+
+  get length() {
+    return this.items.length - this.head;
+  }
+
+  push(item) {
+    this.items.push(item);
+  }
+
+  shift() {
+    const item = this.items[this.head];
+    this.items[this.head++] = undefined;
+    if (this.head === this.items.length) {
+      this.items = [];
+      this.head = 0;
+    } else if ((this.head >= 1024) && (this.head * 2 >= this.items.length)) {
+      this.items = this.items.slice(this.head);
+      this.head = 0;
+    }
+    return item;
+  }
+}
+
+/**
+ * processes requests sent by LootAsync, independent of how they are transported.
+ * send is called with every message that has to go back to LootAsync, exit once the remote side asked to
+ * terminate.
+ * If encodeResults is set, results are produced as json by the native *EncodedAsync functions where
+ * available and passed to send as rawResult (a Buffer) instead of result.
+ * Returns the function that has to be called with each incoming request
+ */
+function createHandler(send, exit, encodeResults = false) {
+  // not loaded before it's needed so this module can be part of a startup snapshot
+  const { Loot, SetErrorLanguageEN } = require('./build/Release/node-loot');
+
+  // one remote may serve several games/profiles at once (see LootPool), requests name the session they
+  // belong to. LootAsync only uses a single session without id
+  const sessions = new Map();
+  // number of requests handled, reported along with the memory usage so the host can decide when
+  // to replace this remote
+  let operations = 0;
+
+  function getSession(id) {
+    let session = sessions.get(id);
+    if (session === undefined) {
+      session = {
+        id,
+        instance: undefined,
+        logLevel: 2, // default: info (matches previous hardcoded filter)
+        lanes: {
+          interactive: new RequestQueue(),
+          background: new RequestQueue(),
+        },
+        waitingBackground: new Map(),
+        processing: false,
+      };
+      sessions.set(id, session);
+    }
+    return session;
+  }
+
+  // call the asynchronous variant of the function where there is one so the event loop stays responsive
+  // (receiving requests, relaying log messages) while libloot is busy
+  function invoke(session, type, args) {
+    const { instance } = session;
+    if ((instance === undefined) || (typeof(instance[type]) !== 'function')) {
+      throw new Error(`unsupported function "${type}"`);
+    }
+    const asyncFunc = instance[`${type}Async`];
+    return (asyncFunc !== undefined)
+      ? asyncFunc.apply(instance, args)
+      : instance[type](...args);
+  }
+
+  // run a single request. With encodeResults the result may be an EncodedResult
+  async function execute(session, type, args) {
+    const { instance } = session;
+    if (type === 'init') {
+      SetErrorLanguageEN();
+      session.instance = new Loot(...args, (level, message) => logCallback(session, level, message));
+      // the level of libloot itself is process-wide, shared with other remotes and the host in worker
+      // mode, so it's left alone. Each instance filters messages by its own level natively
+      session.instance.setLogLevel(session.logLevel);
+      return undefined;
+    } else if (type === 'setLogLevel') {
+      session.logLevel = args[0];
+      if (instance !== undefined) {
+        instance.setLogLevel(session.logLevel);
+      }
+      return undefined;
+    } else if (type === 'batch') {
+      return executeBatch(session, args[0]);
+    } else if (encodeResults && (instance !== undefined) && (instance[`${type}EncodedAsync`] !== undefined)) {
+      // the result only gets passed on so there is no point creating javascript objects for it
+      return new EncodedResult(await instance[`${type}EncodedAsync`](...args));
+    } else if ((type === 'loadPlugins') && (instance !== undefined)) {
+      // suppress BSA hash collision warnings during plugin loading. Only for this session, messages
+      // libloot logs on its own threads can't be attributed and still reach the other sessions (at their
+      // level) while this runs
+      instance.setLogLevel(4);
+      try {
+        return await invoke(session, type, args);
+      } finally {
+        instance.setLogLevel(session.logLevel);
+      }
+    } else {
+      return await invoke(session, type, args);
+    }
+  }
+
+  /**
+   * run a list of requests ({ type, args }) in sequence, stopping at the first error.
+   * The error gets the index of the failed step as batchIndex.
+   * Results to the steps are returned as an array
+   */
+  async function executeBatch(session, steps) {
+    const results = [];
+    for (let i = 0; i < steps.length; ++i) {
+      const { type, args } = steps[i];
+      if ((type === 'batch') || (type === 'terminate') || (type === 'closeSession')) {
+        const error = new Error(`"${type}" can't be part of a batch`);
+        error.batchIndex = i;
+        throw error;
+      }
+      try {
+        results.push(await execute(session, type, args || []));
+      } catch (error) {
+        error.batchIndex = i;
+        throw error;
+      }
+    }
+
+    if (!encodeResults) {
+      return results;
+    }
+
+    // join the results into one json array, including the ones that were encoded natively
+    const parts = [];
+    results.forEach((result, idx) => {
+      parts.push(Buffer.from((idx === 0) ? '[' : ','));
+      if (result instanceof EncodedResult) {
+        parts.push((result.json.length > 0) ? result.json : Buffer.from('null'));
+      } else {
+        const json = JSON.stringify(encodeTypedArrays(result));
+        parts.push(Buffer.from((json !== undefined) ? json : 'null'));
+      }
+    });
+    parts.push(Buffer.from((results.length === 0) ? '[]' : ']'));
+    return new EncodedResult(Buffer.concat(parts));
+  }
+
+  async function handleEvent(session, event) {
+    if (event.type === 'terminate') {
+      send({ id: event.id });
+      exit();
+      return;
+    }
+
+    if (event.type === 'closeSession') {
+      // everything requested for the session before has been handled at this point
+      sessions.delete(session.id);
+      send({ id: event.id });
+      return;
+    }
+
+    try {
+      const result = await execute(session, event.type, event.args);
+      if (result instanceof EncodedResult) {
+        send({ id: event.id, rawResult: result.json });
+      } else {
+        send({ id: event.id, result });
+      }
+    } catch (error) {
+      send({ id: event.id, error: error.message, extraArgs: JSON.stringify(error) });
+    }
+  }
+
+  // requests may arrive while a previous one is still being processed. They are handled one at a
+  // time per session since the game handle can only do one thing at a time, different sessions
+  // are processed concurrently.
+  // Interactive requests are always processed before background ones, within a lane requests are
+  // handled in the order they arrived. A background request replaces an identical one (same function,
+  // same arguments) that is still waiting, the older one is answered with a Superseded error
+  function schedule(session, event) {
+    if (event.priority !== 'background') {
+      session.lanes.interactive.push(event);
+      return;
+    }
+    const key = event.type + JSON.stringify(event.args);
+    const previous = session.waitingBackground.get(key);
+    if (previous !== undefined) {
+      previous.superseded = true;
+      const error = new Error('Superseded by a newer request');
+      error.name = 'Superseded';
+      send({ id: previous.id, error: error.message, extraArgs: JSON.stringify(error) });
+    }
+    event.key = key;
+    session.waitingBackground.set(key, event);
+    session.lanes.background.push(event);
+  }
+
+  function nextEvent(session) {
+    const { lanes, waitingBackground } = session;
+    const event = (lanes.interactive.length > 0)
+      ? lanes.interactive.shift()
+      : lanes.background.shift();
+    if ((event.key !== undefined) && (waitingBackground.get(event.key) === event)) {
+      waitingBackground.delete(event.key);
+    }
+    return event;
+  }
+
+  async function processQueue(session) {
+    const { lanes } = session;
+    session.processing = true;
+    while ((lanes.interactive.length > 0) || (lanes.background.length > 0)) {
+      const event = nextEvent(session);
+      if (!event.superseded) {
+        ++operations;
+        await handleEvent(session, event);
+      }
+    }
+    session.processing = false;
+    send({ stats: { rss: process.memoryUsage.rss(), operations } });
+  }
+
+  // messages below the log level are already filtered out on the native side
+  function logCallback(session, level, message) {
+    send({ log: { level, message }, session: session.id });
+  }
+
+  return (event) => {
+    const session = getSession(event.session);
+    schedule(session, event);
+    if (!session.processing) {
+      processQueue(session);
+    }
+  };
+}
+
+module.exports = {
+  createHandler,
+};
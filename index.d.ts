@@ -13,20 +13,70 @@ export class Group {
 	afterGroups: string[];
 }
 
+// lists of plugin names can be passed as an array, a newline-separated string or a utf-8 Buffer of the same.
+// The latter two avoid converting the list element by element
+export type PluginList = string[] | string | Buffer;
+
 export type LogCallback = (level: number, message: string) => void;
-export type ForkFunction = (module: string, args: string[]) => void;
+/** execArgv are node arguments (e.g. to start from the startup snapshot) that have to precede the module */
+export type ForkFunction = (module: string, args: string[], execArgv?: string[]) => void;
+
+export interface ListLoadStatus {
+  /** false if the file didn't change since it was last loaded so the loaded data was kept */
+  reloaded: boolean;
+  /** hash of the file content, empty if no file was specified */
+  hash: string;
+}
+
+export interface ListsLoadResult {
+  masterlist: ListLoadStatus;
+  userlist: ListLoadStatus;
+  prelude: ListLoadStatus;
+}
+
+export interface IncrementalLoadResult {
+  /** plugins that were parsed */
+  loaded: string[];
+  /** number of plugins whose previously loaded data was kept */
+  unchanged: number;
+  /** plugins loaded before were missing from the list so everything had to be loaded again */
+  reloadedAll: boolean;
+}
+
+export interface MetadataCacheStats {
+  /** metadata lookups answered from the cache */
+  hits: number;
+  /** metadata lookups that went to libloot */
+  misses: number;
+  /** results currently cached */
+  entries: number;
+}
 
 export class Loot {
   constructor(gameId: string, gamePath: string, gameLocalPath: string, language: string, logCallback: LogCallback);
   
   updateMasterlist(masterlistPath: string, repoUrl: string, repoBranch: string): boolean;
   getMasterlistRevision(masterlistPath: string, getShortId: boolean): MasterlistInfo;
-  loadLists(masterlistPath: string, userlistPath: string, preludePath: string): void;
-  loadPlugins(plugins: string[], loadHeadersOnly: boolean): void;
+  // lists whose content didn't change since they were last loaded are skipped
+  loadLists(masterlistPath: string, userlistPath: string, preludePath: string): ListsLoadResult;
+  // with incremental set, only plugins not loaded yet or changed on disk since are parsed
+  loadPlugins(plugins: PluginList, loadHeadersOnly: boolean): void;
+  loadPlugins(plugins: PluginList, loadHeadersOnly: boolean, incremental: true): IncrementalLoadResult;
   getPlugin(pluginName: string): PluginInterface;
-  getPluginMetadata(pluginName: string, includeUserMetadata: boolean, evaluateConditions: boolean): PluginMetadata;
-  sortPlugins(pluginNames: string[]): string[];
-  setLoadOrder(pluginNames: string[]): void;
+  getPluginsSnapshot(): PluginsSnapshot;
+  // with lazy set, the result is a PluginMetadataHandle that converts each field only when it's accessed
+  getPluginMetadata(pluginName: string, includeUserMetadata: boolean, evaluateConditions: boolean, lazy?: boolean): PluginMetadata;
+  // returns one entry per plugin, in the order of the input list, undefined for plugins without metadata
+  getPluginsMetadata(pluginNames: PluginList, includeUserMetadata?: boolean, evaluateConditions?: boolean): PluginMetadata[];
+  sortPlugins(pluginNames: PluginList): string[];
+  /**
+   * keep sort results in this directory (created if necessary) so sorting the same, fully loaded plugins in
+   * the same state (lists, user groups, load order) again, even from another process, doesn't have to run the
+   * sort. Conditions referring to files other than plugins aren't tracked, clearConditionCache and
+   * invalidateConditionsForPaths remove all stored results. An empty path disables the cache
+   */
+  setSortCache(directory: string): void;
+  setLoadOrder(pluginNames: PluginList): void;
   getLoadOrder(): string[];
   loadCurrentLoadOrderState(): void;
   isPluginActive(pluginName: string): boolean;
@@ -36,22 +86,133 @@ export class Loot {
   getGroupsPath(fromGroupName: string, toGroupName: string): Vertex[];
   getGeneralMessages(evaluateConditions: boolean): Message[];
   clearConditionCache(): void;
+  /**
+   * files changed (absolute or relative to the data directory). Drops only the cached metadata whose
+   * conditions refer to one of them, libloot's own condition cache and the sort cache are always cleared
+   * entirely. Returns the number of cached metadata results dropped
+   */
+  invalidateConditionsForPaths(paths: string[]): number;
+  // messages below this level are discarded natively, before they reach the log callback
+  setLogLevel(level: LogLevel): void;
+  /**
+   * metadata results are cached per plugin and parameters until lists are (re-)loaded or user groups set.
+   * Results with evaluated conditions are also dropped by loadPlugins, setLoadOrder,
+   * loadCurrentLoadOrderState and clearConditionCache. Can be called while asynchronous work is pending
+   */
+  getMetadataCacheStats(): MetadataCacheStats;
+
+  // the *Async variants run on a background thread. While any of them is pending, calls to the
+  // synchronous functions throw a "Loot connection is busy" error
+  loadListsAsync(masterlistPath: string, userlistPath: string, preludePath: string): Promise<ListsLoadResult>;
+  loadPluginsAsync(plugins: PluginList, loadHeadersOnly: boolean): Promise<void>;
+  loadPluginsAsync(plugins: PluginList, loadHeadersOnly: boolean, incremental: true): Promise<IncrementalLoadResult>;
+  getPluginAsync(pluginName: string): Promise<PluginInterface>;
+  getPluginsSnapshotAsync(): Promise<PluginsSnapshot>;
+  getPluginMetadataAsync(pluginName: string, includeUserMetadata?: boolean, evaluateConditions?: boolean, lazy?: boolean): Promise<PluginMetadata>;
+  getPluginsMetadataAsync(pluginNames: PluginList, includeUserMetadata?: boolean, evaluateConditions?: boolean): Promise<PluginMetadata[]>;
+  sortPluginsAsync(pluginNames: PluginList): Promise<string[]>;
+  setLoadOrderAsync(pluginNames: PluginList): Promise<void>;
+  getLoadOrderAsync(): Promise<string[]>;
+  loadCurrentLoadOrderStateAsync(): Promise<void>;
+  isPluginActiveAsync(pluginName: string): Promise<boolean>;
+  getGroupsAsync(includeUserGroups: boolean): Promise<Group[]>;
+  getUserGroupsAsync(): Promise<Group[]>;
+  setUserGroupsAsync(groups: Group[]): Promise<void>;
+  getGroupsPathAsync(fromGroupName: string, toGroupName: string): Promise<Vertex[]>;
+  getGeneralMessagesAsync(evaluateConditions: boolean): Promise<Message[]>;
+  clearConditionCacheAsync(): Promise<void>;
+  invalidateConditionsForPathsAsync(paths: string[]): Promise<number>;
+}
+
+export interface LootAsyncOptions {
+  /**
+   * 'process' (default) runs libloot in a separate process spawned through the fork function,
+   * 'worker' runs it in a worker thread of the calling process
+   */
+  mode?: 'process' | 'worker';
+  /**
+   * replace the remote with a new one in the same state once it crosses one of these limits.
+   * Happens between requests, requests made in the meantime are delayed
+   */
+  recycle?: RecycleOptions;
 }
 
+export interface RecycleOptions {
+  /** resident memory of the remote in bytes. In worker mode this is the memory usage of the whole process */
+  maxRss?: number;
+  /** number of requests handled by the remote */
+  maxOperations?: number;
+}
+
+export interface PoolOptions {
+  /** number of idle remotes to keep started. 0 disables the pool */
+  size?: number;
+  mode?: 'process' | 'worker';
+  /** used to spawn pooled processes */
+  onFork?: ForkFunction;
+  /** initialize pooled remotes for this game and load its lists ahead of time, null to stop preloading */
+  preload?: PreloadOptions | null;
+}
+
+export interface PreloadOptions {
+  gameId: string;
+  gamePath: string;
+  gameLocalPath: string;
+  language: string;
+  masterlistPath: string;
+  userlistPath?: string;
+  preludePath?: string;
+}
+
+export type ReadOnlyFunction = 'getMasterlistRevision' | 'getPlugin' | 'getPluginsSnapshot' | 'getPluginMetadata'
+  | 'getPluginsMetadata' | 'sortPlugins' | 'getLoadOrder' | 'isPluginActive' | 'getGroups' | 'getGroupsPath'
+  | 'getUserGroups' | 'getGeneralMessages';
+
+/**
+ * Read-only requests (getters, sortPlugins) identical to one still in flight, with no other request made in
+ * between, share that one's response. Callbacks then receive the same result object, don't modify it
+ */
 export class LootAsync {
-	static create(gameId: string, gamePath: string, gameLocalPath: string, language: string, logCallback: LogCallback, onFork: ForkFunction, callback: (err: Error, loot: LootAsync) => void);
+  /**
+   * keep remotes started and waiting so create doesn't have to wait for one to start up.
+   * Idle remotes keep the process alive, set size to 0 before shutting down
+   */
+  static configurePool(options: PoolOptions): void;
+	static create(gameId: string, gamePath: string, gameLocalPath: string, language: string, logCallback: LogCallback, onFork: ForkFunction, callback: (err: Error, loot: LootAsync) => void, options?: LootAsyncOptions);
+  /**
+   * start a new remote after a RemoteDied error, restoring lists, user groups, load order and loaded
+   * plugins before any other request is handled
+   */
 	restart(callback: (err: Error) => void);
   close(): void;
+  /**
+   * watch the directories for changed files and invalidate the cached condition results referring to them.
+   * Ends when this instance is closed
+   */
+  watchConditionPaths(directories: string[], options?: ConditionWatcherOptions): ConditionWatcher;
+
+  /**
+   * the read-only functions with low priority: requests made through this are only processed when no
+   * other request is waiting and one that is still waiting gets dropped (failing with a Superseded
+   * error) if an identical request (same function and parameters) is made.
+   * Functions changing state aren't available here since they'd be reordered with other requests
+   */
+  background: Pick<LootAsync, ReadOnlyFunction>;
 
   updateMasterlist(masterlistPath: string, repoUrl: string, repoBranch: string, callback: (err: Error, didUpdate: boolean) => void): void;
+  /** not implemented by libloot anymore, the hashes returned by loadLists identify the list revisions */
   getMasterlistRevision(masterlistPath: string, getShortId: boolean, callback: (err: Error, info: MasterlistInfo) => void): void;
-  loadLists(masterlistPath: string, userlistPath: string, preludePath: string, callback: (err: Error) => void): void;
-  loadPlugins(plugins: string[], loadHeadersOnly: boolean): void;
+  loadLists(masterlistPath: string, userlistPath: string, preludePath: string, callback: (err: Error, result: ListsLoadResult) => void): void;
+  loadPlugins(plugins: PluginList, loadHeadersOnly: boolean, callback?: (err: Error) => void): void;
+  loadPlugins(plugins: PluginList, loadHeadersOnly: boolean, incremental: true, callback: (err: Error, result: IncrementalLoadResult) => void): void;
   getPlugin(pluginName: string): PluginInterface;
+  getPluginsSnapshot(callback: (err: Error, snapshot: PluginsSnapshot) => void): void;
   getPluginMetadata(pluginName: string, callback: (err: Error, meta: PluginMetadata) => void): void;
   getPluginMetadata(pluginName: string, includeUserMetadata: boolean, evaluateConditions: boolean, callback: (err: Error, meta: PluginMetadata) => void): void;
-  sortPlugins(pluginNames: string[], callback: (err: Error, sorted: string[]) => void): void;
-  setLoadOrder(pluginNames: string[]): void;
+  getPluginsMetadata(pluginNames: PluginList, includeUserMetadata: boolean, evaluateConditions: boolean, callback: (err: Error, meta: PluginMetadata[]) => void): void;
+  sortPlugins(pluginNames: PluginList, callback: (err: Error, sorted: string[]) => void): void;
+  setSortCache(directory: string, callback?: (err: Error) => void): void;
+  setLoadOrder(pluginNames: PluginList): void;
   getLoadOrder(): string[];
   loadCurrentLoadOrderState(): void;
   isPluginActive(pluginName: string): boolean;
@@ -61,7 +222,91 @@ export class LootAsync {
   getGroupsPath(fromGroupName: string, toGroupName: string): Vertex[];
   getGeneralMessages(evaluateConditions: boolean): Message[];
   clearConditionCache(callback: (err: Error) => void): void;
+  invalidateConditionsForPaths(paths: string[], callback: (err: Error, dropped: number) => void): void;
   setLogLevel(level: LogLevel, callback: (err: Error) => void): void;
+  getMetadataCacheStats(callback: (err: Error, stats: MetadataCacheStats) => void): void;
+
+  /**
+   * run several functions in sequence with a single request, stopping at the first error.
+   * The error has the index of the failed step as batchIndex
+   */
+  batch(steps: BatchStep[], callback: (err: Error, results: any[]) => void): void;
+  /**
+   * load lists, load order and plugins, then optionally sort and fetch metadata, in a single request
+   */
+  bootstrap(options: BootstrapOptions, callback: (err: Error, result: BootstrapResult) => void): void;
+}
+
+export interface LootPoolOptions {
+  /** number of remotes the sessions are distributed across. Defaults to the number of cpu cores, at most 4 */
+  workers?: number;
+  /** number of loadPlugins/sortPlugins calls allowed to run at the same time. Defaults to workers */
+  maxConcurrentHeavy?: number;
+  mode?: 'process' | 'worker';
+  onFork?: ForkFunction;
+}
+
+export interface LootPoolMetrics {
+  heavyRunning: number;
+  heavyQueued: number;
+  /** requests held back, the heavy ones and everything behind them in their session */
+  queued: number;
+  sessions: number;
+  workers: Array<{ sessions: number, pending: number, alive: boolean }>;
+}
+
+export type LootSession = Omit<LootAsync, 'bootstrap' | 'watchConditionPaths'>;
+
+/**
+ * runs sessions for many games on a fixed number of remotes, limiting how many heavy operations
+ * run at the same time
+ */
+export interface ConditionWatcherOptions {
+  /** milliseconds changes are collected for before they are reported. Defaults to 500 */
+  delay?: number;
+  onError?: (err: Error) => void;
+}
+
+/**
+ * reports changed files (absolute paths) in the directories, recursively. paths is null if it's unknown
+ * which files changed
+ */
+export class ConditionWatcher {
+  constructor(directories: string[], onChange: (paths: string[] | null) => void, options?: ConditionWatcherOptions);
+  close(): void;
+}
+
+export class LootPool {
+  constructor(options?: LootPoolOptions);
+  openSession(gameId: string, gamePath: string, gameLocalPath: string, language: string, logCallback: LogCallback, callback: (err: Error, session: LootSession) => void): void;
+  metrics(): LootPoolMetrics;
+  /** closes all sessions and ends the remotes once they are done */
+  close(callback?: () => void): void;
+}
+
+export interface BatchStep {
+  type: string;
+  args?: any[];
+}
+
+export interface BootstrapOptions {
+  masterlistPath?: string;
+  userlistPath?: string;
+  preludePath?: string;
+  plugins: string[];
+  loadHeadersOnly?: boolean;
+  /** only load plugins that changed since the previous call */
+  incremental?: boolean;
+  sort?: boolean;
+  metadata?: boolean;
+}
+
+export interface BootstrapResult {
+  sorted?: string[];
+  metadata?: PluginMetadata[];
+}
+
+export class Superseded extends Error {
 }
 
 export class MasterlistInfo {
@@ -103,6 +348,14 @@ export class PluginMetadata {
 	requirements: File[];
 }
 
+/**
+ * read-only view of plugin metadata kept in native memory. Fields are converted on first access,
+ * toJSON() converts all of them
+ */
+export class PluginMetadataHandle extends PluginMetadata {
+	toJSON(): PluginMetadata;
+}
+
 export class Tag {
 	isAddition: boolean;
 	name: string;
@@ -132,6 +385,41 @@ export class PluginInterface {
 	loadsArchive: boolean;
 }
 
+/**
+ * all loaded plugins as a struct of arrays.
+ * names lists the loaded plugins first (pluginCount entries), followed by masters that aren't loaded themselves.
+ * flags, crc, headerVersion and version have one entry per loaded plugin. The masters of plugin i are the
+ * indices into names stored in masters[masterOffsets[i]] to masters[masterOffsets[i + 1] - 1]
+ */
+export class PluginsSnapshot {
+	names: string[];
+	pluginCount: number;
+	// bit combination of PluginFlags values
+	flags: Uint32Array;
+	// only valid where the hasCRC flag is set
+	crc: Uint32Array;
+	// NaN where unknown
+	headerVersion: Float32Array;
+	version: string[];
+	masterOffsets: Uint32Array;
+	masters: Uint32Array;
+}
+
+export const PluginFlags: {
+	isMaster: number;
+	isLightPlugin: number;
+	IsMediumPlugin: number;
+	IsUpdatePlugin: number;
+	IsBlueprintPlugin: number;
+	isEmpty: number;
+	loadsArchive: number;
+	isValidAsLightPlugin: number;
+	IsValidAsMediumPlugin: number;
+	IsValidAsUpdatePlugin: number;
+	isActive: number;
+	hasCRC: number;
+};
+
 export enum LogLevel {
 	trace = 0,
 	debug = 1,
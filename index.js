@@ -1,9 +1,16 @@
-net = require('net');
-const path = require('path');
+const { Coalescer, READ_ONLY_FUNCTIONS } = require('./coalesce');
+const { Connection } = require('./connection');
+const { AlreadyClosed, Superseded } = require('./errors');
+const { decodeTypedArrays, encodeBatchSteps, encodeBufferArgs } = require('./ipc');
+const { Journal } = require('./journal');
+const { WarmPool } = require('./pool');
+const { LootPool } = require('./scheduler');
+const { ProcessTransport, WorkerTransport, defaultFork, generateId } = require('./transport');
+const { ConditionWatcher } = require('./watcher');
 
-const { Loot, IsCompatible, SetLogLevel } = require('./build/Release/node-loot');
+const pool = new WarmPool();
 
-const CHUNK_SIZE = 32 * 1024;
+const { Loot, IsCompatible, PluginFlags, SetLogLevel } = require('./build/Release/node-loot');
 
 const LogLevel = {
   trace: 0,
@@ -13,43 +20,17 @@ const LogLevel = {
   error: 4,
 };
 
-// interface IPluginsNotLoadedArgs {
-//   name: string;
-//   plugin: string;
-//   func: string;
-//   currentlyLoaded: string[];
-// }
-class PluginNotLoaded extends Error {
-  constructor(args) {
-    super(`Plugin not loaded: "${args.plugin}"; currently loaded: ${args.currentlyLoaded.join(', ')}`);
-    Error.captureStackTrace(this, this.constructor);
-    this.name = this.constructor.name;
-    this.plugin = args.plugin;
-    this.func = args.func;
-    this.currentlyLoaded = args.currentlyLoaded || [];
-  }
-}
-
-class AlreadyClosed extends Error {
-  constructor() {
-    super('Already closed');
-    Error.captureStackTrace(this, this.constructor);
-
-    this.name = this.constructor.name;
-  }
-}
-
-class RemoteDied extends Error {
-  constructor() {
-    super('LOOT process died');
-    Error.captureStackTrace(this, this.constructor);
-
-    this.name = this.constructor.name;
-  }
-}
-
 class LootAsync {
-  static create(gameId, gamePath, gameLocalPath, language, logCallback, onFork, callback) {
+  /**
+   * options.mode selects where libloot runs:
+   *   'process' (default): in a separate process, spawned through onFork
+   *   'worker': in a worker thread of this process, onFork is ignored
+   * options.recycle: { maxRss, maxOperations } replaces the remote with a new one (in the same state:
+   *   lists, user groups, load order and plugins loaded) once it uses more than maxRss bytes of memory or
+   *   has handled maxOperations requests. This happens between requests, requests made in the
+   *   meantime are delayed. In worker mode the memory usage is that of the whole process
+   */
+  static create(gameId, gamePath, gameLocalPath, language, logCallback, onFork, callback, options) {
     try {
       const res = new LootAsync(gameId, gamePath, gameLocalPath, language, logCallback, onFork, (err) => {
         if (err !== null) {
@@ -57,28 +38,26 @@ class LootAsync {
         } else {
           callback(null, res);
         }
-      });
+      }, options);
     } catch (err) {
       callback(err);
     }
   }
 
-  constructor(gameId, gamePath, gameLocalPath, language, logCallback, onFork, callback) {
-    this.queue = [];
+  constructor(gameId, gamePath, gameLocalPath, language, logCallback, onFork, callback, options = {}) {
     this.logCallback = logCallback;
     this.didClose = false;
-    this.dataBuffer = '';
-    if (onFork !== undefined) {
-      this.onFork = onFork;
-    } else {
-      const cp = require('child_process');
-      this.onFork = (script, args) => {
-        cp.spawn(process.execPath, [
-          script,
-          ...args,
-        ]);
-      }
-    }
+    // the read-only functions of this object but requests made through these are only processed when no
+    // "interactive" requests are waiting and they may be superseded by an identical, later request.
+    // Functions changing state aren't offered, they would be reordered with the reads of the same caller
+    this.background = {};
+    this.onFork = (onFork !== undefined) ? onFork : defaultFork;
+    this.mode = (options.mode === 'worker') ? 'worker' : 'process';
+    this.recycleOptions = options.recycle || {};
+    // state changing calls, replayed when the remote is replaced
+    this.journal = new Journal();
+    // identical read-only requests made while one is in flight share its response
+    this.coalescer = new Coalescer();
     this.initArgs = [
       gameId,
       gamePath,
@@ -99,8 +78,11 @@ class LootAsync {
     this.makeProxy('loadLists');
     this.makeProxy('loadPlugins');
     this.makeProxy('getPlugin');
+    this.makeProxy('getPluginsSnapshot');
     this.makeProxy('getPluginMetadata');
+    this.makeProxy('getPluginsMetadata');
     this.makeProxy('sortPlugins');
+    this.makeProxy('setSortCache');
     this.makeProxy('setLoadOrder');
     this.makeProxy('getLoadOrder');
     this.makeProxy('loadCurrentLoadOrderState');
@@ -111,79 +93,218 @@ class LootAsync {
     this.makeProxy('setUserGroups');
     this.makeProxy('getGeneralMessages');
     this.makeProxy('clearConditionCache');
+    this.makeProxy('invalidateConditionsForPaths');
     this.makeProxy('setLogLevel');
+    this.makeProxy('getMetadataCacheStats');
+
+    this.connection = this.connect(initCallback);
+  }
+
+  /**
+   * create a connection to a remote with the game initialized, taking one from the pool if possible.
+   * The callback is called once the game is initialized
+   */
+  connect(callback) {
+    const connection = new Connection((level, message) => this.logCallback(level, message));
+    connection.onStats = stats => this.checkRecycle(connection, stats);
+    const pooled = pool.take(this.mode, this.initArgs);
+    if (pooled !== undefined) {
+      // already running and waiting for requests
+      this.id = (pooled.transport.id !== undefined) ? pooled.transport.id : this.generateId();
+      connection.adopt(pooled.transport);
+      if (pooled.initialized) {
+        setImmediate(() => callback(null));
+      } else {
+        connection.request({
+          type: 'init',
+          args: this.initArgs,
+        }, callback);
+      }
+      return connection;
+    }
 
     this.id = this.generateId();
-    this.ipc = new net.Server();
-    try {
-      // this seems to fail for some users with EINVAL. why?
-      // May be a wine-only problem but that's not confirmed
-      this.ipc.listen(`\\\\?\\pipe\\loot-ipc-${this.id}`, () => {
-        this.ipc.on('connection', socket => {
-          this.socket = socket;
-          socket
-          .on('data', data => {
-            try {
-              this.dataBuffer += data.toString();
-              const messages = this.dataBuffer.split('\uFFFF');
-              // Keep incomplete chunk (last element after split if no trailing delimiter)
-              if (!this.dataBuffer.endsWith('\uFFFF')) {
-                this.dataBuffer = messages.pop();
-              } else {
-                this.dataBuffer = '';
-              }
-              // Process each complete message
-              for (const msg of messages) {
-                if (msg.length > 0) {
-                  this.handleResponse(JSON.parse(msg));
-                }
-              }
-            } catch (err) {
-              this.logCallback(4, err.message);
-            }
-          })
-          .on('error', err => {
-            if (!!this.currentCallback) {
-              this.currentCallback(err);
-              this.currentCallback = undefined;
-            } else {
-              this.logCallback(4, err.message);
-            }
-          });
-        })
+    const transport = (this.mode === 'worker')
+      ? new WorkerTransport()
+      : new ProcessTransport(this.id, this.onFork);
+    connection.open(transport, err => {
+      if (err !== null) {
+        callback(err);
+      } else {
+        connection.restart([{
+          message: { type: 'init', args: this.initArgs },
+          callback,
+        }]);
+      }
+    });
+    return connection;
+  }
 
-        this.restart(initCallback);
-      })
-      .on('error', (err) => {
-        initCallback(err);
-      });
-    } catch (err) {
-      initCallback(new Error('failed to establish pipe'));
+  checkRecycle(connection, stats) {
+    const { maxRss, maxOperations } = this.recycleOptions;
+    if ((connection !== this.connection) || (this.held !== undefined) || this.didClose) {
+      return;
+    }
+    if (((maxRss !== undefined) && (stats.rss > maxRss))
+        || ((maxOperations !== undefined) && (stats.operations >= maxOperations))) {
+      this.recycle();
     }
   }
 
+  /**
+   * replace the remote with a new one in the same state. Requests made in the meantime are held
+   * back and sent to the new remote once it has caught up
+   */
+  recycle() {
+    const previous = this.connection;
+    this.held = [];
+    const finish = (next) => {
+      const held = this.held;
+      this.held = undefined;
+      if (next !== previous) {
+        this.connection = next;
+        previous.request({ type: 'terminate' }, () => previous.close());
+      }
+      held.forEach(([message, callback]) => this.dispatch(message, callback));
+    };
+
+    // the new remote starts up while the previous one finishes what it was asked to do
+    let started = false;
+    let drained = false;
+    let failed = false;
+    const next = this.connect(err => {
+      if (err) {
+        this.logCallback(3, `failed to replace LOOT process: ${err.message}`);
+        failed = true;
+      }
+      started = true;
+      replay();
+    });
+    previous.whenIdle(() => {
+      drained = true;
+      replay();
+    });
+
+    const replay = () => {
+      if (!started || !drained) {
+        return;
+      }
+      if (failed) {
+        next.request({ type: 'terminate' }, () => next.close());
+        return finish(previous);
+      }
+      const steps = this.journal.steps();
+      if (steps.length === 0) {
+        return finish(next);
+      }
+      next.request({ type: 'batch', args: [steps] }, err => {
+        if (err) {
+          this.logCallback(3, `failed to replace LOOT process: ${err.message}`);
+          next.request({ type: 'terminate' }, () => next.close());
+          finish(previous);
+        } else {
+          finish(next);
+        }
+      });
+    };
+  }
+
+  /**
+   * start a new remote after the previous one died. The state of the game handle (lists, user groups,
+   * load order, loaded plugins) is restored in a single request right after init, before any other
+   * request is handled. The callback is called once that is done
+   */
   restart(callback) {
-    this.worker = this.onFork(`${__dirname}${path.sep}async.js`, [this.id]);
-    this.currentCallback = () => {
-      this.enqueue({
-        type: 'init',
-        args: this.initArgs,
-      }, callback);
+    const steps = this.journal.steps();
+    let initFailed = false;
+    // init has to be the first request the new process handles
+    const requests = [{
+      message: { type: 'init', args: this.initArgs },
+      callback: err => {
+        if (err) {
+          initFailed = true;
+          callback(err);
+        } else if (steps.length === 0) {
+          callback(null);
+        }
+      },
+    }];
+    if (steps.length > 0) {
+      requests.push({
+        message: { type: 'batch', args: [steps] },
+        callback: err => {
+          if (initFailed) {
+            return;
+          }
+          if (err && (err.batchIndex !== undefined)) {
+            // only the steps before the failed one are in effect now
+            this.journal.clear();
+            this.journal.record('batch', [steps.slice(0, err.batchIndex)]);
+          }
+          callback(err || null);
+        },
+      });
     }
+    this.connection.restart(requests);
+  }
+
+  /**
+   * keep a number of remotes started and waiting so that create doesn't have to wait for a new
+   * process/thread to start up and load the addon. Instances taken from the pool are replaced in the background.
+   * options:
+   *   size: number of idle remotes to keep around. 0 (the default) disables the pool and ends all idle remotes
+   *   mode: 'process' or 'worker', only instances created with the same mode are taken from the pool
+   *   onFork: used to spawn pooled processes (instead of the onFork passed to create)
+   *   preload: { gameId, gamePath, gameLocalPath, language, masterlistPath, userlistPath, preludePath }
+   *     initializes the pooled remotes for this game and loads the lists ahead of time. Only instances
+   *     created for exactly this game are taken from the pool then. Calling loadLists on such an
+   *     instance with the same files does nothing as long as they didn't change
+   * Idle processes keep the node process alive, set the size to 0 before shutting down
+   */
+  static configurePool(options) {
+    pool.configure(options);
   }
 
   generateId() {
-    const chars = 'abcdefghijklmnopqrstuvwxyz0123456789';
-    let res = [];
-    for (let i = 0; i < 8; ++i) {
-      res.push(chars[Math.floor(Math.random() * chars.length)]);
+    return generateId();
+  }
+
+  /**
+   * watch the directories for changed files and invalidate the cached condition results that refer to
+   * them (see ConditionWatcher). Stops when this instance is closed or when close is called on the result.
+   * options.delay: milliseconds changes are collected for before they are reported
+   */
+  watchConditionPaths(directories, options = {}) {
+    const watcher = new ConditionWatcher(directories, paths => {
+      if (this.didClose) {
+        return;
+      }
+      const report = err => {
+        if (err) {
+          this.logCallback(3, `failed to invalidate conditions: ${err.message}`);
+        }
+      };
+      // interactive so that reads made after the change was noticed don't get stale results
+      if (paths === null) {
+        this.clearConditionCache(report);
+      } else {
+        this.invalidateConditionsForPaths(paths, report);
+      }
+    }, options);
+    if (this.watchers === undefined) {
+      this.watchers = [];
     }
-    return res.join('');
+    this.watchers.push(watcher);
+    return watcher;
   }
 
   close() {
-    this.enqueue({ type: 'terminate' }, () => {
-      this.worker = undefined;
+    if (this.watchers !== undefined) {
+      this.watchers.forEach(watcher => watcher.close());
+    }
+    // terminate goes into the background lane so that everything requested before is still processed
+    this.enqueue({ type: 'terminate', priority: 'background' }, () => {
+      this.connection.close();
     });
     this.didClose = true;
   }
@@ -193,7 +314,7 @@ class LootAsync {
   }
 
   makeProxy(name) {
-    this[name] = (...args) => {
+    const proxy = (priority) => (...args) => {
       let cb = args[args.length - 1];
       if (typeof(cb) !== 'function') {
         cb = undefined;
@@ -203,97 +324,111 @@ class LootAsync {
 
       this.enqueue({
         type: name,
-        args,
+        args: encodeBufferArgs(args),
+        priority,
       }, cb);
     };
-  }
 
-  enqueue(message, callback) {
-    if (this.didClose) {
-      return callback(new AlreadyClosed());
-    }
-    if (!this.currentCallback) {
-      this.deliver(message, callback);
-    } else {
-      this.queue.push({ message, callback });
+    this[name] = proxy('interactive');
+    if (READ_ONLY_FUNCTIONS.has(name)) {
+      this.background[name] = proxy('background');
     }
   }
 
-  deliver(message, callback) {
-    this.currentCallback = callback;
-    const handleError = err => {
-      if (!!err) {
-        if (!!this.currentCallback) {
-          if (err.code === 'EPIPE') {
-            this.currentCallback(new RemoteDied());
-          } else {
-            this.currentCallback(err);
-          }
-        }
-        this.processQueue();
-      }
-    };
-    try {
-      const data = JSON.stringify(message) + '\uFFFF';
-      // Chunk large messages to avoid Windows named pipe size limits
-      for (let i = 0; i < data.length; i += CHUNK_SIZE) {
-        this.socket.write(data.slice(i, i + CHUNK_SIZE), handleError);
+  /**
+   * run several functions ([{ type: 'loadPlugins', args: [...] }, ...]) in sequence with a single request.
+   * Stops at the first error, that error has the index of the failed step as batchIndex.
+   * The callback receives the results of all steps as an array
+   */
+  batch(steps, callback) {
+    this.enqueue({
+      type: 'batch',
+      args: [encodeBatchSteps(steps)],
+    }, (err, results) => {
+      if (err) {
+        callback(err);
+      } else {
+        // only top-level properties of a result are checked for encoded typed arrays
+        callback(null, results.map(result => decodeTypedArrays(result)));
       }
-    } catch (err) {
-      handleError(err);
-    }
+    });
   }
 
-  processQueue() {
-    if (this.queue.length > 0) {
-      const next = this.queue.shift();
-      this.deliver(next.message, next.callback);
-    } else {
-      this.currentCallback = undefined;
+  /**
+   * everything needed to open a profile, in one request:
+   * loads the master- and userlist (if masterlistPath is set), the current load order and the plugins
+   * (only the ones that changed since the previous call if options.incremental is set),
+   * then sorts them (if options.sort is set) and fetches their metadata (if options.metadata is set).
+   * The callback receives { sorted, metadata }, each undefined if it wasn't requested
+   */
+  bootstrap(options, callback) {
+    const steps = [];
+    if (options.masterlistPath !== undefined) {
+      steps.push({
+        type: 'loadLists',
+        args: [options.masterlistPath, options.userlistPath || '', options.preludePath || ''],
+      });
+    }
+    steps.push({ type: 'loadCurrentLoadOrderState', args: [] });
+    steps.push({
+      type: 'loadPlugins',
+      args: [options.plugins, options.loadHeadersOnly === true, options.incremental === true],
+    });
+    if (options.sort) {
+      steps.push({ type: 'sortPlugins', args: [options.plugins] });
+    }
+    if (options.metadata) {
+      steps.push({ type: 'getPluginsMetadata', args: [options.plugins, true, true] });
     }
+
+    this.batch(steps, (err, results) => {
+      if (err) {
+        return callback(err);
+      }
+      const resultOf = type => results[steps.findIndex(step => step.type === type)];
+      callback(null, {
+        sorted: options.sort ? resultOf('sortPlugins') : undefined,
+        metadata: options.metadata ? resultOf('getPluginsMetadata') : undefined,
+      });
+    });
+  }
+
+  enqueue(message, callback) {
+    this.coalescer.run(message, callback, (msg, cb) => this.dispatch(msg, cb));
   }
 
-  handleResponse(msg) {
-    // don't touch the queue when relaying logs
-    if (msg.log) {
-      this.logCallback(msg.log.level, msg.log.message);
+  dispatch(message, callback) {
+    if (this.held !== undefined) {
+      // waiting for the remote to be replaced
+      this.held.push([message, callback]);
       return;
     }
-
-    // relay result, then process next request in the queue, if any
-    try {
-      if (!!this.currentCallback) {
-        if (msg.error) {
-          const extraArgs = JSON.parse(msg.extraArgs);
-          let err;
-          if (extraArgs.name === 'AlreadyClosed') {
-            err = new AlreadyClosed();
-          } else if (extraArgs.name === 'PluginNotLoaded') {
-            err = new PluginNotLoaded(extraArgs);
-          } else {
-            err = new Error(msg.error);
-          }
-          Object.assign(err, extraArgs);
-          this.currentCallback(err);
-        } else {
-          this.currentCallback(null, msg.result);
-        }
-      }
-      this.processQueue();
-    } catch (err) {
-      // don't want to suppress an error but
-      // if we don't trigger the queue here, this proxy is dead
-      this.processQueue();
-      throw err;
+    if ((this.didClose) && (message.type !== 'terminate')) {
+      return callback(new AlreadyClosed());
     }
+    this.connection.request(message, (err, result) => {
+      if (!err) {
+        this.journal.record(message.type, message.args);
+      } else if ((message.type === 'batch') && (err.batchIndex !== undefined)) {
+        // the steps before the failed one took effect
+        this.journal.record('batch', [message.args[0].slice(0, err.batchIndex)]);
+      }
+      if (callback !== undefined) {
+        callback(err, result);
+      }
+    });
   }
 }
 
 module.exports = {
   AlreadyClosed,
+  ConditionWatcher,
   LogLevel,
   Loot,
   LootAsync,
+  LootPool,
   IsCompatible,
+  PluginFlags,
   SetLogLevel,
+  Superseded,
 };
@@ -0,0 +1,266 @@
+/**
+ * Communication between LootAsync (index.js) and the process running async.js.
+ *
+ * Messages from LootAsync are requests: { id, type, args, priority?, session? }
+ *   priority is either "interactive" (the default) or "background"
+ *   session identifies the game handle when one remote serves several (LootPool), type "closeSession"
+ *   releases it
+ * Messages from the remote process are
+ *   { ready: true } once it's able to accept requests,
+ *   { id, result } or { id, error, extraArgs } in response to the request with that id,
+ *   { log: { level, message }, session? } for log messages
+ *   { stats: { rss, operations } } whenever it ran out of requests to process
+ *   { shm: [position, length] } standing in for a message that was placed in the shared ring
+ * Requests are sent without waiting for the responses to previous requests, the remote process
+ * handles them in the order they arrived (per session).
+ */
+
+const os = require('os');
+const path = require('path');
+
+// Windows named pipes can't take arbitrarily large writes
+const CHUNK_SIZE = 32 * 1024;
+const HEADER_SIZE = 4;
+
+/**
+ * path of the socket used to talk to the worker with the specified id.
+ * This is a named pipe on Windows and a unix domain socket everywhere else
+ */
+function ipcPath(id) {
+  return process.platform === 'win32'
+    ? `\\\\?\\pipe\\loot-ipc-${id}`
+    : path.join(os.tmpdir(), `loot-ipc-${id}.sock`);
+}
+
+// messages at least this large go through the shared memory ring, if there is one
+const SHM_THRESHOLD = 64 * 1024;
+const SHM_SIZE = 16 * 1024 * 1024;
+// index of the counter in the region header holding the position up to which the host has read
+const SHM_CONSUMED = 0;
+
+function shmName(id) {
+  return process.platform === 'win32'
+    ? `Local\\loot-shm-${id}`
+    : `/loot-shm-${id}`;
+}
+
+/**
+ * single-producer/single-consumer ring buffer over a native SharedRegion.
+ * The remote process writes large messages into the ring and only sends their position over the pipe,
+ * the host copies them out and advances the consumed counter, freeing the space.
+ * Messages are read in the order they were written since the pipe delivers the positions in order
+ */
+class SharedRing {
+  constructor(region) {
+    this.region = region;
+    this.capacity = region.capacity;
+    // a new remote process continues wherever the previous one stopped
+    this.writePos = region.getCounter(SHM_CONSUMED);
+  }
+
+  /**
+   * copy the data into the ring, returning its position or undefined if there isn't enough free space
+   */
+  tryWrite(data) {
+    const free = this.capacity - (this.writePos - this.region.getCounter(SHM_CONSUMED));
+    if (data.length > free) {
+      return undefined;
+    }
+    const position = this.writePos;
+    this.region.write(position, data);
+    this.writePos += data.length;
+    return position;
+  }
+
+  read(position, length) {
+    const data = this.region.read(position, length);
+    this.region.setCounter(SHM_CONSUMED, position + length);
+    return data;
+  }
+
+  close() {
+    this.region.close();
+  }
+}
+
+const TYPED_ARRAYS = {
+  Uint8Array, Uint32Array, Int32Array, Float32Array, Float64Array,
+};
+
+/**
+ * typed arrays (as returned by getPluginsSnapshot) would be serialized as plain objects by JSON.stringify.
+ * Only the top-level properties of a result are checked, that's the only place they appear.
+ * (A replacer/reviver function would be invoked for every single value in every message)
+ */
+function encodeTypedArrays(result) {
+  if ((result === null) || (typeof(result) !== 'object') || Array.isArray(result)) {
+    return result;
+  }
+  let copy;
+  for (const key of Object.keys(result)) {
+    const value = result[key];
+    if (ArrayBuffer.isView(value)) {
+      if (copy === undefined) {
+        copy = { ...result };
+      }
+      copy[key] = { typedArray: value.constructor.name, data: Array.from(value) };
+    }
+  }
+  return copy !== undefined ? copy : result;
+}
+
+function decodeTypedArrays(result) {
+  if ((result === null) || (typeof(result) !== 'object') || Array.isArray(result)) {
+    return result;
+  }
+  for (const key of Object.keys(result)) {
+    const value = result[key];
+    if ((value !== null) && (typeof(value) === 'object')
+        && (TYPED_ARRAYS[value.typedArray] !== undefined) && Array.isArray(value.data)) {
+      // NaN is serialized as null
+      result[key] = TYPED_ARRAYS[value.typedArray].from(value.data, v => (v === null) ? NaN : v);
+    }
+  }
+  return result;
+}
+
+/**
+ * Buffers (plugin lists) would be serialized as { type: 'Buffer', data: [...] } by JSON.stringify and
+ * arrive as Uint8Array through postMessage, the native side accepts neither. They are passed as the string
+ * they contain instead. Only top-level arguments are checked, that's where plugin lists appear
+ */
+function encodeBufferArgs(args) {
+  return args.some(arg => Buffer.isBuffer(arg))
+    ? args.map(arg => Buffer.isBuffer(arg) ? arg.toString('utf8') : arg)
+    : args;
+}
+
+// the same for the steps of a batch
+function encodeBatchSteps(steps) {
+  return steps.map(step => ({ ...step, args: encodeBufferArgs(step.args || []) }));
+}
+
+/**
+ * encode a message as a frame: 4 byte little endian payload length followed by the utf-8 encoded json
+ */
+function encodeFrame(message) {
+  const json = JSON.stringify(message);
+  const length = Buffer.byteLength(json);
+  const frame = Buffer.allocUnsafe(HEADER_SIZE + length);
+  frame.writeUInt32LE(length, 0);
+  frame.write(json, HEADER_SIZE);
+  return frame;
+}
+
+/**
+ * encode the response to a request as a frame, with a result that's already encoded as json.
+ * An empty result stands for undefined
+ */
+function encodeRawFrame(id, rawResult) {
+  if (rawResult.length === 0) {
+    return encodeFrame({ id });
+  }
+  const prefix = `{"id":${id},"result":`;
+  const prefixLength = Buffer.byteLength(prefix);
+  const length = prefixLength + rawResult.length + 1;
+  const frame = Buffer.allocUnsafe(HEADER_SIZE + length);
+  frame.writeUInt32LE(length, 0);
+  frame.write(prefix, HEADER_SIZE);
+  rawResult.copy(frame, HEADER_SIZE + prefixLength);
+  frame[HEADER_SIZE + length - 1] = 0x7d; // }
+  return frame;
+}
+
+function writeFrame(socket, frame, callback) {
+  if (frame.length <= CHUNK_SIZE) {
+    socket.write(frame, callback);
+    return;
+  }
+  for (let offset = 0; offset < frame.length; offset += CHUNK_SIZE) {
+    const end = Math.min(offset + CHUNK_SIZE, frame.length);
+    socket.write(frame.subarray(offset, end), (end === frame.length) ? callback : undefined);
+  }
+}
+
+/**
+ * splits a stream of chunks into frames. Received chunks are kept as they are until a frame is
+ * complete, so each byte is copied at most once and each frame is decoded exactly once
+ */
+class FrameDecoder {
+  constructor(onFrame) {
+    this.onFrame = onFrame;
+    this.chunks = [];
+    this.bufferedLength = 0;
+    this.frameLength = -1;
+  }
+
+  push(chunk) {
+    this.chunks.push(chunk);
+    this.bufferedLength += chunk.length;
+
+    while (true) {
+      if (this.frameLength === -1) {
+        if (this.bufferedLength < HEADER_SIZE) {
+          return;
+        }
+        this.frameLength = this.take(HEADER_SIZE).readUInt32LE(0);
+      }
+      if (this.bufferedLength < this.frameLength) {
+        return;
+      }
+      const payload = this.take(this.frameLength);
+      this.frameLength = -1;
+      this.onFrame(payload);
+    }
+  }
+
+  // remove the specified number of bytes from the front of the buffered chunks
+  take(length) {
+    if (length === 0) {
+      return Buffer.alloc(0);
+    }
+    let result;
+    const first = this.chunks[0];
+    if (first.length >= length) {
+      result = first.subarray(0, length);
+      if (first.length === length) {
+        this.chunks.shift();
+      } else {
+        this.chunks[0] = first.subarray(length);
+      }
+    } else {
+      result = Buffer.allocUnsafe(length);
+      let offset = 0;
+      while (offset < length) {
+        const chunk = this.chunks[0];
+        const count = Math.min(chunk.length, length - offset);
+        chunk.copy(result, offset, 0, count);
+        offset += count;
+        if (count === chunk.length) {
+          this.chunks.shift();
+        } else {
+          this.chunks[0] = chunk.subarray(count);
+        }
+      }
+    }
+    this.bufferedLength -= length;
+    return result;
+  }
+}
+
+module.exports = {
+  FRAME_HEADER_SIZE: HEADER_SIZE,
+  FrameDecoder,
+  SHM_SIZE,
+  SHM_THRESHOLD,
+  SharedRing,
+  decodeTypedArrays,
+  encodeBatchSteps,
+  encodeBufferArgs,
+  encodeFrame,
+  encodeRawFrame,
+  encodeTypedArrays,
+  ipcPath,
+  shmName,
+  writeFrame,
+};
@@ -0,0 +1,101 @@
+// plugin lists may also be passed as newline-separated strings. Split the same way the native
+// side does: a trailing \r is stripped and empty lines are dropped
+function pluginList(plugins) {
+  if (Array.isArray(plugins)) {
+    return plugins;
+  }
+  return plugins.toString().split('\n')
+    .map(line => line.endsWith('\r') ? line.slice(0, -1) : line)
+    .filter(line => line.length > 0);
+}
+
+/**
+ * records the calls that changed the state of a game handle so that a new remote can be brought into
+ * the same state. Only the calls that matter for the current state are kept, e.g. only the latest
+ * loadLists call
+ */
+class Journal {
+  constructor() {
+    this.clear();
+  }
+
+  clear() {
+    this.logLevel = undefined;
+    this.sortCache = undefined;
+    this.lists = undefined;
+    this.userGroups = undefined;
+    this.loadOrderLoaded = false;
+    // loadPlugins calls, in order. A call loading all plugins of an earlier one replaces that
+    this.plugins = [];
+  }
+
+  get empty() {
+    return (this.logLevel === undefined)
+        && (this.sortCache === undefined)
+        && (this.lists === undefined)
+        && (this.userGroups === undefined)
+        && !this.loadOrderLoaded
+        && (this.plugins.length === 0);
+  }
+
+  /**
+   * to be called after a request succeeded
+   */
+  record(type, args) {
+    if (type === 'setLogLevel') {
+      this.logLevel = args;
+    } else if (type === 'setSortCache') {
+      this.sortCache = args;
+    } else if (type === 'loadLists') {
+      this.lists = args;
+      if (args[1]) {
+        // loading the userlist replaces user groups set before
+        this.userGroups = undefined;
+      }
+    } else if (type === 'setUserGroups') {
+      this.userGroups = args;
+    } else if ((type === 'setLoadOrder') || (type === 'loadCurrentLoadOrderState')) {
+      // setLoadOrder has written the load order to disk already, reading it back doesn't
+      // overwrite changes made since
+      this.loadOrderLoaded = true;
+    } else if (type === 'loadPlugins') {
+      const [plugins, headersOnly, incremental] = args;
+      const loading = new Set(pluginList(plugins));
+      // after an incremental load exactly the listed plugins are loaded
+      this.plugins = this.plugins.filter(previous => (incremental !== true)
+        && (((previous[1] === true) !== (headersOnly === true))
+            || pluginList(previous[0]).some(plugin => !loading.has(plugin))));
+      this.plugins.push(args);
+    } else if (type === 'batch') {
+      args[0].forEach(step => this.record(step.type, step.args || []));
+    }
+  }
+
+  /**
+   * the requests ({ type, args }) that recreate the recorded state on a freshly initialized game handle
+   */
+  steps() {
+    const steps = [];
+    if (this.logLevel !== undefined) {
+      steps.push({ type: 'setLogLevel', args: this.logLevel });
+    }
+    if (this.sortCache !== undefined) {
+      steps.push({ type: 'setSortCache', args: this.sortCache });
+    }
+    if (this.lists !== undefined) {
+      steps.push({ type: 'loadLists', args: this.lists });
+    }
+    if (this.userGroups !== undefined) {
+      steps.push({ type: 'setUserGroups', args: this.userGroups });
+    }
+    if (this.loadOrderLoaded) {
+      steps.push({ type: 'loadCurrentLoadOrderState', args: [] });
+    }
+    this.plugins.forEach(args => steps.push({ type: 'loadPlugins', args }));
+    return steps;
+  }
+}
+
+module.exports = {
+  Journal,
+};
@@ -0,0 +1,141 @@
+const { ProcessTransport, WorkerTransport, defaultFork, generateId } = require('./transport');
+
+// ids of the requests used to preload a game, LootAsync ids start at 1
+const PRELOAD_INIT = -1;
+const PRELOAD_LISTS = -2;
+
+/**
+ * remotes that have been started and are connected (addon loaded) but haven't been told which game
+ * to handle yet. LootAsync takes one of these instead of starting a new one, if available.
+ * With preload set, the remotes are also initialized for one game and have its lists loaded already
+ */
+class WarmPool {
+  constructor() {
+    this.size = 0;
+    this.mode = 'process';
+    this.onFork = defaultFork;
+    this.idle = [];
+    this.starting = new Set();
+    // incremented whenever the settings change, remotes started before that are discarded once they're ready
+    this.generation = 0;
+  }
+
+  configure(options) {
+    const mode = (options.mode !== undefined) ? options.mode : this.mode;
+    const onFork = (options.onFork !== undefined) ? options.onFork : this.onFork;
+    const preload = (options.preload !== undefined) ? (options.preload || undefined) : this.preload;
+    if ((mode !== this.mode) || (onFork !== this.onFork)
+        || (JSON.stringify(preload) !== JSON.stringify(this.preload))) {
+      // remotes started with the previous settings are of no use anymore
+      this.idle.splice(0).forEach(transport => this.discard(transport));
+      ++this.generation;
+    }
+    this.mode = mode;
+    this.onFork = onFork;
+    this.preload = preload;
+    this.size = (options.size !== undefined) ? options.size : this.size;
+    this.idle.splice(this.size).forEach(transport => this.discard(transport));
+    this.refill();
+  }
+
+  /**
+   * take an idle remote, returns undefined if there is none for the specified mode and game.
+   * If the pool preloads a game, only an instance for that game (same init arguments) gets one.
+   * The result tells whether the remote is already initialized
+   */
+  take(mode, initArgs) {
+    if ((mode !== this.mode) || (this.idle.length === 0)) {
+      return undefined;
+    }
+    const initialized = this.preload !== undefined;
+    if (initialized && (JSON.stringify(initArgs) !== JSON.stringify(this.preloadInitArgs()))) {
+      return undefined;
+    }
+    const transport = this.idle.shift();
+    setImmediate(() => this.refill());
+    return { transport, initialized };
+  }
+
+  preloadInitArgs() {
+    const { gameId, gamePath, gameLocalPath, language } = this.preload;
+    return [gameId, gamePath, gameLocalPath, language];
+  }
+
+  refill() {
+    while ((this.idle.length + this.starting.size) < this.size) {
+      this.start();
+    }
+  }
+
+  start() {
+    let transport;
+    const generation = this.generation;
+    const preload = this.preload;
+    const becameReady = () => {
+      if (!this.starting.delete(transport)) {
+        return;
+      }
+      if ((generation === this.generation) && (this.idle.length < this.size)) {
+        this.idle.push(transport);
+      } else {
+        this.discard(transport);
+      }
+    };
+    const handlers = {
+      onMessage: msg => {
+        if (msg.ready) {
+          if (preload === undefined) {
+            becameReady();
+          } else {
+            // the game gets initialized and the lists loaded before the remote counts as ready
+            const { gameId, gamePath, gameLocalPath, language,
+                    masterlistPath, userlistPath, preludePath } = preload;
+            transport.send({ id: PRELOAD_INIT, type: 'init', args: [gameId, gamePath, gameLocalPath, language] }, () => undefined);
+            transport.send({ id: PRELOAD_LISTS, type: 'loadLists', args: [masterlistPath, userlistPath || '', preludePath || ''] }, () => undefined);
+          }
+        } else if ((msg.id === PRELOAD_INIT) || (msg.id === PRELOAD_LISTS)) {
+          if (msg.error !== undefined) {
+            this.starting.delete(transport);
+            this.discard(transport);
+          } else if (msg.id === PRELOAD_LISTS) {
+            becameReady();
+          }
+        }
+      },
+      onDisconnect: () => {
+        // not replaced right away, if remotes die immediately after starting this would never end
+        this.starting.delete(transport);
+        const idx = this.idle.indexOf(transport);
+        if (idx !== -1) {
+          this.idle.splice(idx, 1);
+        }
+        transport.close();
+      },
+      onError: () => undefined,
+    };
+    transport = (this.mode === 'worker')
+      ? new WorkerTransport(handlers)
+      : new ProcessTransport(generateId(), this.onFork, handlers);
+    this.starting.add(transport);
+    transport.open(err => {
+      if (err !== null) {
+        this.starting.delete(transport);
+      } else {
+        transport.spawn();
+      }
+    });
+  }
+
+  discard(transport) {
+    const close = () => transport.close();
+    try {
+      transport.send({ id: 0, type: 'terminate' }, close);
+    } catch (err) {
+      close();
+    }
+  }
+}
+
+module.exports = {
+  WarmPool,
+};
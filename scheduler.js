@@ -0,0 +1,400 @@
+const os = require('os');
+
+const { Coalescer, READ_ONLY_FUNCTIONS } = require('./coalesce');
+const { Connection } = require('./connection');
+const { AlreadyClosed, RemoteDied } = require('./errors');
+const { decodeTypedArrays, encodeBatchSteps, encodeBufferArgs } = require('./ipc');
+const { Journal } = require('./journal');
+const { ProcessTransport, WorkerTransport, defaultFork, generateId } = require('./transport');
+
+// functions that keep libloot busy on several threads for a long time
+const HEAVY_FUNCTIONS = new Set(['loadPlugins', 'sortPlugins']);
+
+const PROXY_FUNCTIONS = [
+  'updateFile',
+  'getMasterlistRevision',
+  'loadLists',
+  'loadPlugins',
+  'getPlugin',
+  'getPluginsSnapshot',
+  'getPluginMetadata',
+  'getPluginsMetadata',
+  'sortPlugins',
+  'setSortCache',
+  'setLoadOrder',
+  'getLoadOrder',
+  'loadCurrentLoadOrderState',
+  'isPluginActive',
+  'getGroups',
+  'getGroupsPath',
+  'getUserGroups',
+  'setUserGroups',
+  'getGeneralMessages',
+  'clearConditionCache',
+  'invalidateConditionsForPaths',
+  'setLogLevel',
+  'getMetadataCacheStats',
+];
+
+function isHeavy(message) {
+  if (message.type === 'batch') {
+    return message.args[0].find(step => HEAVY_FUNCTIONS.has(step.type)) !== undefined;
+  }
+  return HEAVY_FUNCTIONS.has(message.type);
+}
+
+// stable across runs so a game always ends up on the same remote
+function hashString(input) {
+  let hash = 0x811c9dc5;
+  for (let i = 0; i < input.length; ++i) {
+    hash ^= input.charCodeAt(i);
+    hash = Math.imul(hash, 0x01000193) >>> 0;
+  }
+  return hash;
+}
+
+/**
+ * one game handle inside a remote shared with other sessions. Provides the same functions as LootAsync
+ */
+class LootSession {
+  constructor(pool, worker, id, initArgs, logCallback) {
+    this.pool = pool;
+    this.worker = worker;
+    this.id = id;
+    this.initArgs = initArgs;
+    this.logCallback = logCallback;
+    // requests not sent to the remote yet, held back while a heavy one waits for a free slot
+    this.queue = [];
+    this.didClose = false;
+    // set when the remote died, the game handle has to be recreated with restart
+    this.lost = false;
+    this.background = {};
+    // state changing calls, replayed by restart
+    this.journal = new Journal();
+    // see LootAsync
+    this.coalescer = new Coalescer();
+
+    PROXY_FUNCTIONS.forEach(name => this.makeProxy(name));
+  }
+
+  /**
+   * create the game handle anew after the remote died and restore its state, see LootAsync.restart
+   */
+  restart(callback) {
+    if (callback === undefined) {
+      callback = () => undefined;
+    }
+    const steps = this.journal.steps();
+    let initFailed = false;
+    this.lost = false;
+    this.enqueue({ type: 'init', args: this.initArgs }, err => {
+      initFailed = !!err;
+      if (err || (steps.length === 0)) {
+        callback(err || null);
+      }
+    });
+    if (steps.length > 0) {
+      this.enqueue({ type: 'batch', args: [steps] }, err => {
+        if (initFailed) {
+          return;
+        }
+        if (err && (err.batchIndex !== undefined)) {
+          this.journal.clear();
+          this.journal.record('batch', [steps.slice(0, err.batchIndex)]);
+        }
+        callback(err || null);
+      });
+    }
+  }
+
+  close() {
+    this.enqueue({ type: 'closeSession', priority: 'background' }, () => {
+      this.pool.sessionClosed(this);
+    });
+    this.didClose = true;
+  }
+
+  isClosed() {
+    return this.didClose;
+  }
+
+  makeProxy(name) {
+    const proxy = (priority) => (...args) => {
+      let cb = args[args.length - 1];
+      if (typeof(cb) !== 'function') {
+        cb = undefined;
+      } else {
+        args = args.slice(0, args.length - 1);
+      }
+
+      this.enqueue({
+        type: name,
+        args: encodeBufferArgs(args),
+        priority,
+      }, cb);
+    };
+
+    this[name] = proxy('interactive');
+    if (READ_ONLY_FUNCTIONS.has(name)) {
+      this.background[name] = proxy('background');
+    }
+  }
+
+  /**
+   * see LootAsync.batch
+   */
+  batch(steps, callback) {
+    this.enqueue({
+      type: 'batch',
+      args: [encodeBatchSteps(steps)],
+    }, (err, results) => {
+      if (err) {
+        callback(err);
+      } else {
+        callback(null, results.map(result => decodeTypedArrays(result)));
+      }
+    });
+  }
+
+  enqueue(message, callback) {
+    this.coalescer.run(message, callback, (msg, cb) => this.dispatch(msg, cb));
+  }
+
+  dispatch(message, callback) {
+    if (callback === undefined) {
+      callback = () => undefined;
+    }
+    if (this.didClose) {
+      return callback(new AlreadyClosed());
+    }
+    if (this.lost && (message.type !== 'init')) {
+      return callback(new RemoteDied());
+    }
+    this.queue.push({
+      message: { ...message, session: this.id },
+      callback: (err, result) => {
+        if (!err) {
+          this.journal.record(message.type, message.args);
+        } else if ((message.type === 'batch') && (err.batchIndex !== undefined)) {
+          this.journal.record('batch', [message.args[0].slice(0, err.batchIndex)]);
+        }
+        callback(err, result);
+      },
+    });
+    this.pool.pump(this);
+  }
+}
+
+/**
+ * runs the games of many LootAsync-like sessions on a fixed number of remotes and limits how many
+ * heavy operations (loadPlugins, sortPlugins) run at the same time across all of them, since libloot
+ * already uses several threads for those.
+ * Sessions are assigned to a remote by game so sessions for the same game share one.
+ * Requests of a session are handled in order, a session whose next request is heavy waits until a
+ * slot is free, sessions get slots in the order they started waiting.
+ * options:
+ *   workers: number of remotes, defaults to the number of cpu cores (at most 4)
+ *   maxConcurrentHeavy: number of heavy operations allowed at a time, defaults to the number of remotes
+ *   mode: 'process' (default) or 'worker', see LootAsync.create
+ *   onFork: used to spawn the remote processes
+ * Log messages are passed to the log callback of the session that caused them. libloot can't attribute
+ * messages it logs on threads it started itself, those reach all sessions on that remote
+ */
+class LootPool {
+  constructor(options = {}) {
+    const workerCount = (options.workers !== undefined)
+      ? options.workers
+      : Math.max(1, Math.min(4, os.cpus().length));
+    this.maxConcurrentHeavy = (options.maxConcurrentHeavy !== undefined)
+      ? options.maxConcurrentHeavy
+      : workerCount;
+    this.mode = (options.mode === 'worker') ? 'worker' : 'process';
+    this.onFork = (options.onFork !== undefined) ? options.onFork : defaultFork;
+    this.workers = [];
+    for (let i = 0; i < workerCount; ++i) {
+      this.workers.push({ connection: undefined, alive: false, sessions: new Map() });
+    }
+    this.heavyRunning = 0;
+    // sessions whose next request is heavy, waiting for a free slot
+    this.waiting = [];
+    this.nextSessionId = 1;
+    this.didClose = false;
+  }
+
+  /**
+   * create a session for a game. Parameters are the same as for LootAsync.create, the callback
+   * receives the session once the game handle is initialized
+   */
+  openSession(gameId, gamePath, gameLocalPath, language, logCallback, callback) {
+    if (this.didClose) {
+      return callback(new AlreadyClosed());
+    }
+    const worker = this.workers[hashString(gameId) % this.workers.length];
+    const session = new LootSession(this, worker, `s${this.nextSessionId++}`,
+      [gameId, gamePath, gameLocalPath, language], logCallback);
+    worker.sessions.set(session.id, session);
+    session.enqueue({ type: 'init', args: session.initArgs }, err => {
+      if (err) {
+        worker.sessions.delete(session.id);
+        callback(err);
+      } else {
+        callback(null, session);
+      }
+    });
+  }
+
+  /**
+   * snapshot of the scheduling state:
+   *   heavyRunning: heavy operations currently running
+   *   heavyQueued: heavy operations waiting for a slot
+   *   queued: requests held back (heavy ones and everything behind them in their session)
+   *   sessions: number of open sessions
+   *   workers: per remote, the number of sessions, the number of requests sent but not answered yet
+   *     and whether it's running
+   */
+  metrics() {
+    let heavyQueued = 0;
+    let queued = 0;
+    let sessions = 0;
+    const workers = this.workers.map(worker => {
+      worker.sessions.forEach(session => {
+        ++sessions;
+        queued += session.queue.length;
+        heavyQueued += session.queue.filter(entry => isHeavy(entry.message)).length;
+      });
+      return {
+        sessions: worker.sessions.size,
+        pending: (worker.connection !== undefined) ? worker.connection.pendingCount : 0,
+        alive: worker.alive,
+      };
+    });
+    return {
+      heavyRunning: this.heavyRunning,
+      heavyQueued,
+      queued,
+      sessions,
+      workers,
+    };
+  }
+
+  /**
+   * close all sessions and end the remotes once they are done
+   */
+  close(callback) {
+    this.didClose = true;
+    let remaining = 1;
+    const done = () => {
+      if ((--remaining === 0) && (callback !== undefined)) {
+        callback();
+      }
+    };
+    this.workers.forEach(worker => {
+      if (worker.connection === undefined) {
+        return;
+      }
+      ++remaining;
+      const connection = worker.connection;
+      worker.closing = () => {
+        worker.alive = false;
+        worker.connection = undefined;
+        connection.request({ type: 'terminate' }, () => {
+          connection.close();
+          done();
+        });
+      };
+      if (worker.sessions.size === 0) {
+        worker.closing();
+      } else {
+        Array.from(worker.sessions.values())
+          .filter(session => !session.didClose)
+          .forEach(session => session.close());
+      }
+    });
+    done();
+  }
+
+  sessionClosed(session) {
+    const worker = session.worker;
+    worker.sessions.delete(session.id);
+    if ((worker.sessions.size === 0) && (worker.closing !== undefined)) {
+      worker.closing();
+    }
+  }
+
+  // send requests of the session until one has to wait for a slot
+  pump(session) {
+    if (this.waiting.includes(session)) {
+      // sessions waiting for a slot are resumed in order by releaseSlot
+      return;
+    }
+    while (session.queue.length > 0) {
+      const heavy = isHeavy(session.queue[0].message);
+      if (heavy && (this.heavyRunning >= this.maxConcurrentHeavy)) {
+        this.waiting.push(session);
+        return;
+      }
+      const { message, callback } = session.queue.shift();
+      if (heavy) {
+        ++this.heavyRunning;
+      }
+      this.connect(session.worker).request(message, (err, result) => {
+        if (heavy) {
+          this.releaseSlot();
+        }
+        callback(err, result);
+      });
+    }
+  }
+
+  releaseSlot() {
+    --this.heavyRunning;
+    while ((this.waiting.length > 0) && (this.heavyRunning < this.maxConcurrentHeavy)) {
+      this.pump(this.waiting.shift());
+    }
+  }
+
+  // the connection to the remote of the worker, (re-)starting it if necessary
+  connect(worker) {
+    if (worker.connection === undefined) {
+      const id = generateId();
+      worker.connection = new Connection((level, message, sessionId) => {
+        if (sessionId !== undefined) {
+          const session = worker.sessions.get(sessionId);
+          if (session !== undefined) {
+            session.logCallback(level, message);
+          }
+        } else {
+          worker.sessions.forEach(session => session.logCallback(level, message));
+        }
+      });
+      worker.connection.onDisconnect = () => {
+        // all game handles in the remote are gone, it's started again on the next request
+        worker.alive = false;
+        worker.sessions.forEach(session => {
+          session.lost = true;
+        });
+      };
+      const transport = (this.mode === 'worker')
+        ? new WorkerTransport()
+        : new ProcessTransport(id, this.onFork);
+      worker.connection.open(transport, err => {
+        if (err !== null) {
+          worker.connection.failPending(err);
+          worker.connection = undefined;
+          worker.alive = false;
+        } else {
+          worker.connection.start();
+        }
+      });
+      worker.alive = true;
+    } else if (!worker.alive) {
+      worker.connection.restart();
+      worker.alive = true;
+    }
+    return worker.connection;
+  }
+}
+
+module.exports = {
+  LootPool,
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "property_keys.h"
+
+/**
+ * state of the addon that has to exist once per javascript environment (main thread and each worker)
+ */
+struct AddonData {
+  AddonData(const Napi::Env &env)
+    : keys(env)
+  {
+  }
+
+  PropertyKeys keys;
+  Napi::FunctionReference metadataHandleConstructor;
+};
@@ -0,0 +1,102 @@
+#include "condition_paths.h"
+#include <algorithm>
+#include <cctype>
+#include <regex>
+
+// libloot treats a path containing any of these as a regular expression for the file name
+static const char *REGEX_CHARACTERS = ":\\*?|";
+
+static const std::string GHOST_EXTENSION = ".ghost";
+
+std::string normalizeConditionPath(std::string path) {
+  std::replace(path.begin(), path.end(), '\\', '/');
+  std::transform(path.begin(), path.end(), path.begin(), [](unsigned char ch) { return std::tolower(ch); });
+  while (path.compare(0, 2, "./") == 0) {
+    path.erase(0, 2);
+  }
+  if ((path.size() > GHOST_EXTENSION.size())
+      && (path.compare(path.size() - GHOST_EXTENSION.size(), GHOST_EXTENSION.size(), GHOST_EXTENSION) == 0)) {
+    path.resize(path.size() - GHOST_EXTENSION.size());
+  }
+  return path;
+}
+
+void ConditionPaths::addPath(const std::string &path) {
+  size_t separator = path.find_last_of('/');
+  std::string fileName = (separator == std::string::npos) ? path : path.substr(separator + 1);
+  if (fileName.find_first_of(REGEX_CHARACTERS) == std::string::npos) {
+    m_Paths.insert(normalizeConditionPath(path));
+  } else {
+    // only the file name is a regular expression, the directory is literal
+    m_Patterns.emplace_back((separator == std::string::npos) ? "" : normalizeConditionPath(path.substr(0, separator)),
+                            fileName);
+  }
+}
+
+void ConditionPaths::addCondition(const std::string &condition) {
+  // function name, opening parenthesis and a quoted string. Strings in conditions can't contain quotes
+  size_t pos = 0;
+  while ((pos = condition.find('(', pos)) != std::string::npos) {
+    size_t start = condition.find_first_not_of(" \t", pos + 1);
+    ++pos;
+    if ((start == std::string::npos) || (condition[start] != '"')) {
+      continue;
+    }
+    size_t end = condition.find('"', start + 1);
+    if (end == std::string::npos) {
+      break;
+    }
+    addPath(condition.substr(start + 1, end - start - 1));
+    pos = end + 1;
+  }
+}
+
+void ConditionPaths::addMetadata(const loot::PluginMetadata &metadata) {
+  addPath(metadata.GetName());
+  for (const auto &files : { metadata.GetLoadAfterFiles(), metadata.GetRequirements(), metadata.GetIncompatibilities() }) {
+    for (const auto &file : files) {
+      addCondition(file.GetCondition());
+      addCondition(file.GetConstraint());
+    }
+  }
+  for (const auto &message : metadata.GetMessages()) {
+    addCondition(message.GetCondition());
+  }
+  for (const auto &tag : metadata.GetTags()) {
+    addCondition(tag.GetCondition());
+  }
+  for (const auto &cleaningData : { metadata.GetDirtyInfo(), metadata.GetCleanInfo() }) {
+    for (const auto &info : cleaningData) {
+      addCondition(info.GetCondition());
+    }
+  }
+}
+
+bool ConditionPaths::matches(const std::vector<std::string> &paths) const {
+  for (const auto &path : paths) {
+    if (m_Paths.find(path) != m_Paths.end()) {
+      return true;
+    }
+    if (m_Patterns.empty()) {
+      continue;
+    }
+
+    size_t separator = path.find_last_of('/');
+    std::string parent = (separator == std::string::npos) ? "" : path.substr(0, separator);
+    std::string fileName = (separator == std::string::npos) ? path : path.substr(separator + 1);
+    for (const auto &pattern : m_Patterns) {
+      if (pattern.first != parent) {
+        continue;
+      }
+      try {
+        if (std::regex_match(fileName, std::regex(pattern.second, std::regex::ECMAScript | std::regex::icase))) {
+          return true;
+        }
+      } catch (const std::regex_error&) {
+        // libloot would have rejected the condition, can't tell what it refers to
+        return true;
+      }
+    }
+  }
+  return false;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <loot/api.h>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * normalized form of a path as conditions use it: relative to the data directory (the game directory is "..")
+ * with forward slashes, lower case and without a ".ghost" extension
+ */
+std::string normalizeConditionPath(std::string path);
+
+/**
+ * the files one or more conditions refer to. Conditions aren't parsed completely, the first string argument of
+ * every function call is taken to be a path (or a regular expression for the file name if it contains any of
+ * the characters libloot treats as regex). For functions that don't refer to files (e.g. active) this
+ * only leads to entries being dropped unnecessarily
+ */
+class ConditionPaths {
+public:
+
+  void addCondition(const std::string &condition);
+
+  // a path as written in a condition
+  void addPath(const std::string &path);
+
+  // all conditions in the (unevaluated) metadata and the plugin itself, whose crc selects the cleaning info
+  void addMetadata(const loot::PluginMetadata &metadata);
+
+  // whether any of the (normalized) paths is one the conditions refer to
+  bool matches(const std::vector<std::string> &paths) const;
+
+private:
+
+  std::set<std::string> m_Paths;
+  // parent directory (normalized) and the regular expression for the file name
+  std::vector<std::pair<std::string, std::string>> m_Patterns;
+
+};
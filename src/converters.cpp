@@ -0,0 +1,188 @@
+#include "converters.h"
+#include "property_keys.h"
+#include "util.h"
+
+// all converters build their objects through makeObject so that objects of the same type share
+// their property keys and hidden class. Keep the property order fixed
+
+template<>
+Napi::Value toNAPI<loot::Tag>(const Napi::Env &env, const loot::Tag &input) {
+  return makeObject(env, {
+    { Key::condition, Napi::Value::From(env, input.GetCondition()) },
+    { Key::name, Napi::Value::From(env, input.GetName()) },
+    { Key::isAddition, Napi::Value::From(env, input.IsAddition()) },
+  });
+}
+
+template<>
+Napi::Value toNAPI<loot::MessageContent>(const Napi::Env &env, const loot::MessageContent &input) {
+  return makeObject(env, {
+    { Key::text, Napi::Value::From(env, input.GetText()) },
+    { Key::language, Napi::Value::From(env, input.GetLanguage()) },
+  });
+}
+
+template<>
+Napi::Value toNAPI<loot::Message>(const Napi::Env &env, const loot::Message &input) {
+  return makeObject(env, {
+    { Key::condition, Napi::Value::From(env, input.GetCondition()) },
+    { Key::content, toNAPI(env, input.GetContent()) },
+    { Key::type, Napi::Value::From(env, static_cast<unsigned int>(input.GetType())) },
+  });
+}
+
+template<>
+Napi::Value toNAPI<loot::PluginCleaningData>(const Napi::Env &env, const loot::PluginCleaningData &input) {
+  return makeObject(env, {
+    { Key::cleaningUtility, Napi::Value::From(env, input.GetCleaningUtility()) },
+    { Key::crc, Napi::Value::From(env, input.GetCRC()) },
+    { Key::deletedNavmeshCount, Napi::Value::From(env, input.GetDeletedNavmeshCount()) },
+    { Key::deletedReferenceCount, Napi::Value::From(env, input.GetDeletedReferenceCount()) },
+    // { Key::info, toNAPI(env, input.GetInfo()) },
+    { Key::itmCount, Napi::Value::From(env, input.GetITMCount()) },
+  });
+}
+
+template<>
+Napi::Value toNAPI<loot::File>(const Napi::Env &env, const loot::File &input) {
+  return makeObject(env, {
+    { Key::condition, Napi::Value::From(env, input.GetCondition()) },
+    { Key::displayName, Napi::Value::From(env, input.GetDisplayName()) },
+    { Key::name, Napi::Value::From(env, static_cast<std::string>(input.GetName())) },
+  });
+}
+
+template<>
+Napi::Value toNAPI<loot::Location>(const Napi::Env &env, const loot::Location &input) {
+  return makeObject(env, {
+    { Key::name, Napi::Value::From(env, input.GetName()) },
+    { Key::url, Napi::Value::From(env, input.GetURL()) },
+  });
+}
+
+template<>
+Napi::Value toNAPI<loot::Vertex>(const Napi::Env &env, const loot::Vertex &input) {
+  auto edgeType = input.GetTypeOfEdgeToNextVertex();
+  return makeObject(env, {
+    { Key::name, Napi::Value::From(env, input.GetName()) },
+    { Key::typeOfEdgeToNextVertex, Napi::Value::From(env, edgeType.has_value() ? convertEdgeType(edgeType.value()) : "") },
+  });
+}
+
+template<>
+Napi::Value toNAPI<loot::Group>(const Napi::Env &env, const loot::Group &input) {
+  return makeObject(env, {
+    { Key::afterGroups, toNAPI(env, input.GetAfterGroups()) },
+    { Key::description, Napi::Value::From(env, input.GetDescription()) },
+    { Key::name, Napi::Value::From(env, input.GetName()) },
+  });
+}
+
+template<>
+Napi::Value toNAPI<loot::PluginMetadata>(const Napi::Env &env, const loot::PluginMetadata &input) {
+  return makeObject(env, {
+    { Key::cleanInfo, toNAPI(env, input.GetCleanInfo()) },
+    { Key::dirtyInfo, toNAPI(env, input.GetDirtyInfo()) },
+    { Key::group, Napi::Value::From(env, input.GetGroup().value_or("")) },
+    { Key::incompatibilities, toNAPI(env, input.GetIncompatibilities()) },
+    { Key::loadAfterFiles, toNAPI(env, input.GetLoadAfterFiles()) },
+    { Key::locations, toNAPI(env, input.GetLocations()) },
+    { Key::messages, toNAPI(env, input.GetMessages()) },
+    { Key::name, Napi::Value::From(env, input.GetName()) },
+    { Key::requirements, toNAPI(env, input.GetRequirements()) },
+    { Key::tags, toNAPI(env, input.GetTags()) },
+  });
+}
+
+template<>
+Napi::Value toNAPI<loot::PluginInterface>(const Napi::Env &env, const loot::PluginInterface &input) {
+  auto crc = input.GetCRC();
+  auto headerVersion = input.GetHeaderVersion();
+  auto version = input.GetVersion();
+  return makeObject(env, {
+    { Key::bashTags, toNAPI(env, input.GetBashTags()) },
+    { Key::crc, crc.has_value() ? Napi::Value::From(env, crc.value()) : env.Null() },
+    { Key::headerVersion, headerVersion.has_value() ? Napi::Value::From(env, headerVersion.value()) : env.Null() },
+    { Key::masters, toNAPI(env, input.GetMasters()) },
+    { Key::name, Napi::Value::From(env, input.GetName()) },
+    { Key::version, version.has_value() ? Napi::Value::From(env, version.value()) : env.Null() },
+    { Key::isEmpty, Napi::Value::From(env, input.IsEmpty()) },
+    { Key::IsUpdatePlugin, Napi::Value::From(env, input.IsUpdatePlugin()) },
+    { Key::isLightPlugin, Napi::Value::From(env, input.IsLightPlugin()) },
+    { Key::IsMediumPlugin, Napi::Value::From(env, input.IsMediumPlugin()) },
+    { Key::IsBlueprintPlugin, Napi::Value::From(env, input.IsBlueprintPlugin()) },
+    { Key::isMaster, Napi::Value::From(env, input.IsMaster()) },
+    { Key::IsValidAsMediumPlugin, Napi::Value::From(env, input.IsValidAsMediumPlugin()) },
+    { Key::isValidAsLightPlugin, Napi::Value::From(env, input.IsValidAsLightPlugin()) },
+    { Key::IsValidAsUpdatePlugin, Napi::Value::From(env, input.IsValidAsUpdatePlugin()) },
+    { Key::loadsArchive, Napi::Value::From(env, input.LoadsArchive()) },
+  });
+}
+
+template<>
+Napi::Value toNAPI<PluginsSnapshot>(const Napi::Env &env, const PluginsSnapshot &input) {
+  Napi::Array versions = Napi::Array::New(env, input.versions.size());
+  uint32_t index = 0;
+  for (const auto &version : input.versions) {
+    versions.Set(index++, version.has_value() ? Napi::String::New(env, *version) : env.Null());
+  }
+
+  return makeObject(env, {
+    { Key::names, toNAPI(env, input.names) },
+    { Key::pluginCount, Napi::Value::From(env, input.pluginCount) },
+    { Key::flags, toTypedArray(env, input.flags) },
+    { Key::crc, toTypedArray(env, input.crcs) },
+    { Key::headerVersion, toTypedArray(env, input.headerVersions) },
+    { Key::version, versions },
+    { Key::masterOffsets, toTypedArray(env, input.masterOffsets) },
+    { Key::masters, toTypedArray(env, input.masters) },
+  });
+}
+
+static Napi::Value listStatus(const Napi::Env &env, const ListLoadStatus &input) {
+  return makeObject(env, {
+    { Key::reloaded, Napi::Boolean::New(env, input.reloaded) },
+    { Key::hash, Napi::String::New(env, input.hash) },
+  });
+}
+
+template<>
+Napi::Value toNAPI<ListsLoadResult>(const Napi::Env &env, const ListsLoadResult &input) {
+  return makeObject(env, {
+    { Key::masterlist, listStatus(env, input.masterlist) },
+    { Key::userlist, listStatus(env, input.userlist) },
+    { Key::prelude, listStatus(env, input.prelude) },
+  });
+}
+
+template<>
+Napi::Value toNAPI<IncrementalLoadResult>(const Napi::Env &env, const IncrementalLoadResult &input) {
+  return makeObject(env, {
+    { Key::loaded, toNAPI(env, input.loaded) },
+    { Key::unchanged, Napi::Value::From(env, input.unchanged) },
+    { Key::reloadedAll, Napi::Boolean::New(env, input.reloadedAll) },
+  });
+}
+
+template<>
+Napi::Value toNAPI<MetadataCacheStats>(const Napi::Env &env, const MetadataCacheStats &input) {
+  return makeObject(env, {
+    { Key::hits, Napi::Number::New(env, static_cast<double>(input.hits)) },
+    { Key::misses, Napi::Number::New(env, static_cast<double>(input.misses)) },
+    { Key::entries, Napi::Number::New(env, static_cast<double>(input.entries)) },
+  });
+}
+
+template<>
+Napi::Value toNAPI<std::monostate>(const Napi::Env &env, const std::monostate&) {
+  return env.Undefined();
+}
+
+template<>
+loot::Group fromNAPI(const Napi::Value &info) {
+  Napi::Object obj = info.As<Napi::Object>();
+  return loot::Group(
+    obj.Get("name").ToString().Utf8Value(),
+    fromNAPIArr<std::string>(obj.Get("afterGroups")),
+    obj.Get("description").ToString().Utf8Value());
+}
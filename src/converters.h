@@ -0,0 +1,29 @@
+#pragma once
+
+#include <loot/api.h>
+#include <variant>
+#include "napi_helpers.h"
+#include "loaded_lists.h"
+#include "metadata_cache.h"
+#include "plugin_fingerprints.h"
+#include "snapshot.h"
+
+// conversions between libloot types and javascript values
+
+template<> Napi::Value toNAPI<loot::Tag>(const Napi::Env &env, const loot::Tag &input);
+template<> Napi::Value toNAPI<loot::MessageContent>(const Napi::Env &env, const loot::MessageContent &input);
+template<> Napi::Value toNAPI<loot::Message>(const Napi::Env &env, const loot::Message &input);
+template<> Napi::Value toNAPI<loot::PluginCleaningData>(const Napi::Env &env, const loot::PluginCleaningData &input);
+template<> Napi::Value toNAPI<loot::File>(const Napi::Env &env, const loot::File &input);
+template<> Napi::Value toNAPI<loot::Location>(const Napi::Env &env, const loot::Location &input);
+template<> Napi::Value toNAPI<loot::Vertex>(const Napi::Env &env, const loot::Vertex &input);
+template<> Napi::Value toNAPI<loot::Group>(const Napi::Env &env, const loot::Group &input);
+template<> Napi::Value toNAPI<loot::PluginMetadata>(const Napi::Env &env, const loot::PluginMetadata &input);
+template<> Napi::Value toNAPI<loot::PluginInterface>(const Napi::Env &env, const loot::PluginInterface &input);
+template<> Napi::Value toNAPI<PluginsSnapshot>(const Napi::Env &env, const PluginsSnapshot &input);
+template<> Napi::Value toNAPI<ListsLoadResult>(const Napi::Env &env, const ListsLoadResult &input);
+template<> Napi::Value toNAPI<IncrementalLoadResult>(const Napi::Env &env, const IncrementalLoadResult &input);
+template<> Napi::Value toNAPI<MetadataCacheStats>(const Napi::Env &env, const MetadataCacheStats &input);
+template<> Napi::Value toNAPI<std::monostate>(const Napi::Env &env, const std::monostate &input);
+
+template<> loot::Group fromNAPI(const Napi::Value &info);
@@ -0,0 +1,31 @@
+#include "file_hash.h"
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+std::string FNV1a::hex() const {
+  char res[17];
+  snprintf(res, sizeof(res), "%016llx", static_cast<unsigned long long>(m_Hash));
+  return std::string(res);
+}
+
+std::optional<std::string> hashFile(const std::filesystem::path &filePath) {
+  static const size_t CHUNK_SIZE = 64 * 1024;
+
+  std::ifstream file(filePath, std::ios::binary);
+  if (!file) {
+    return std::nullopt;
+  }
+
+  FNV1a hash;
+  std::vector<char> buffer(CHUNK_SIZE);
+  while (file) {
+    file.read(buffer.data(), buffer.size());
+    hash.update(buffer.data(), static_cast<size_t>(file.gcount()));
+  }
+  if (file.bad()) {
+    return std::nullopt;
+  }
+
+  return hash.hex();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+/**
+ * 64-bit FNV-1a. Not cryptographically secure, this is only meant to tell whether something changed
+ */
+class FNV1a {
+public:
+
+  void update(const void *data, size_t length) {
+    const unsigned char *bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < length; ++i) {
+      m_Hash ^= bytes[i];
+      m_Hash *= 0x100000001b3ULL;
+    }
+  }
+
+  // strings are terminated so that e.g. "ab", "c" and "a", "bc" produce different hashes
+  void update(const std::string &input) {
+    update(input.data(), input.size());
+    update("", 1);
+  }
+
+  // 16 hex digits
+  std::string hex() const;
+
+private:
+
+  uint64_t m_Hash{ 0xcbf29ce484222325ULL };
+
+};
+
+/**
+ * hash of the file content as 16 hex digits. nullopt if the file can't be read
+ */
+std::optional<std::string> hashFile(const std::filesystem::path &filePath);
@@ -0,0 +1,125 @@
+#include "json_encoder.h"
+#include "util.h"
+#include <cstdio>
+
+void JSONWriter::value(const std::string &input) {
+  m_Buffer.push_back('"');
+  for (char ch : input) {
+    switch (ch) {
+      case '"': m_Buffer.append("\\\""); break;
+      case '\\': m_Buffer.append("\\\\"); break;
+      case '\b': m_Buffer.append("\\b"); break;
+      case '\f': m_Buffer.append("\\f"); break;
+      case '\n': m_Buffer.append("\\n"); break;
+      case '\r': m_Buffer.append("\\r"); break;
+      case '\t': m_Buffer.append("\\t"); break;
+      default: {
+        if (static_cast<unsigned char>(ch) < 0x20) {
+          char escaped[8];
+          snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(ch));
+          m_Buffer.append(escaped);
+        } else {
+          // utf-8 sequences are passed through as they are
+          m_Buffer.push_back(ch);
+        }
+      } break;
+    }
+  }
+  m_Buffer.push_back('"');
+}
+
+void JSONWriter::value(const char *input) {
+  value(std::string(input));
+}
+
+void JSONWriter::value(bool input) {
+  m_Buffer.append(input ? "true" : "false");
+}
+
+void JSONWriter::value(unsigned int input) {
+  m_Buffer.append(std::to_string(input));
+}
+
+void JSONWriter::value(const loot::Tag &input) {
+  beginObject();
+  field("condition", input.GetCondition());
+  field("name", input.GetName());
+  field("isAddition", input.IsAddition());
+  endObject();
+}
+
+void JSONWriter::value(const loot::MessageContent &input) {
+  beginObject();
+  field("text", input.GetText());
+  field("language", input.GetLanguage());
+  endObject();
+}
+
+void JSONWriter::value(const loot::Message &input) {
+  beginObject();
+  field("condition", input.GetCondition());
+  field("content", input.GetContent());
+  field("type", static_cast<unsigned int>(input.GetType()));
+  endObject();
+}
+
+void JSONWriter::value(const loot::PluginCleaningData &input) {
+  beginObject();
+  field("cleaningUtility", input.GetCleaningUtility());
+  field("crc", static_cast<unsigned int>(input.GetCRC()));
+  field("deletedNavmeshCount", input.GetDeletedNavmeshCount());
+  field("deletedReferenceCount", input.GetDeletedReferenceCount());
+  field("itmCount", input.GetITMCount());
+  endObject();
+}
+
+void JSONWriter::value(const loot::File &input) {
+  beginObject();
+  field("condition", input.GetCondition());
+  field("displayName", input.GetDisplayName());
+  field("name", static_cast<std::string>(input.GetName()));
+  endObject();
+}
+
+void JSONWriter::value(const loot::Location &input) {
+  beginObject();
+  field("name", input.GetName());
+  field("url", input.GetURL());
+  endObject();
+}
+
+void JSONWriter::value(const loot::Vertex &input) {
+  auto edgeType = input.GetTypeOfEdgeToNextVertex();
+  beginObject();
+  field("name", input.GetName());
+  field("typeOfEdgeToNextVertex", edgeType.has_value() ? convertEdgeType(edgeType.value()) : "");
+  endObject();
+}
+
+void JSONWriter::value(const loot::Group &input) {
+  beginObject();
+  field("afterGroups", input.GetAfterGroups());
+  field("description", input.GetDescription());
+  field("name", input.GetName());
+  endObject();
+}
+
+void JSONWriter::value(const loot::PluginMetadata &input) {
+  beginObject();
+  field("cleanInfo", input.GetCleanInfo());
+  field("dirtyInfo", input.GetDirtyInfo());
+  field("group", input.GetGroup().value_or(""));
+  field("incompatibilities", input.GetIncompatibilities());
+  field("loadAfterFiles", input.GetLoadAfterFiles());
+  field("locations", input.GetLocations());
+  field("messages", input.GetMessages());
+  field("name", input.GetName());
+  field("requirements", input.GetRequirements());
+  field("tags", input.GetTags());
+  endObject();
+}
+
+template<>
+Napi::Value toNAPI<EncodedJSON>(const Napi::Env &env, const EncodedJSON &input) {
+  return Napi::Buffer<char>::Copy(env, input.json.data(), input.json.size());
+}
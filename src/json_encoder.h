@@ -0,0 +1,116 @@
+#pragma once
+
+#include <loot/api.h>
+#include <optional>
+#include <string>
+#include <vector>
+#include <napi.h>
+#include "napi_helpers.h"
+
+/**
+ * serializes libloot types straight to json, without creating javascript objects first.
+ * The output is what JSON.stringify produces for the objects created by the toNAPI converters
+ * (same property names, same order), so the receiving side can't tell the difference.
+ * Used on the LootAsync hot path where results are only ever converted to be sent to another process
+ */
+class JSONWriter {
+public:
+
+  JSONWriter() {
+    m_Buffer.reserve(4096);
+  }
+
+  void value(const std::string &input);
+  void value(const char *input);
+  void value(bool input);
+  void value(unsigned int input);
+  void null() {
+    m_Buffer.append("null");
+  }
+
+  void value(const loot::Tag &input);
+  void value(const loot::MessageContent &input);
+  void value(const loot::Message &input);
+  void value(const loot::PluginCleaningData &input);
+  void value(const loot::File &input);
+  void value(const loot::Location &input);
+  void value(const loot::Vertex &input);
+  void value(const loot::Group &input);
+  void value(const loot::PluginMetadata &input);
+
+  template<typename T>
+  void value(const std::vector<T> &input) {
+    m_Buffer.push_back('[');
+    bool first = true;
+    for (const auto &iter : input) {
+      if (!first) {
+        m_Buffer.push_back(',');
+      }
+      first = false;
+      value(iter);
+    }
+    m_Buffer.push_back(']');
+  }
+
+  // like JSON.stringify, an undefined array element is written as null
+  template<typename T>
+  void value(const std::optional<T> &input) {
+    if (input.has_value()) {
+      value(*input);
+    } else {
+      null();
+    }
+  }
+
+  std::string release() {
+    return std::move(m_Buffer);
+  }
+
+private:
+
+  void beginObject() {
+    m_Buffer.push_back('{');
+    m_FirstField = true;
+  }
+
+  void endObject() {
+    m_Buffer.push_back('}');
+    m_FirstField = false;
+  }
+
+  // once a field was written the enclosing object needs a separator before the next one, no matter
+  // what nested objects were written inside it, so a single flag is enough
+  template<typename T>
+  void field(const char *name, const T &input) {
+    if (!m_FirstField) {
+      m_Buffer.push_back(',');
+    }
+    m_Buffer.push_back('"');
+    m_Buffer.append(name);
+    m_Buffer.append("\":");
+    value(input);
+    m_FirstField = false;
+  }
+
+private:
+
+  std::string m_Buffer;
+  bool m_FirstField{ false };
+
+};
+
+/**
+ * utf-8 encoded json, returned to javascript as a Buffer
+ */
+struct EncodedJSON {
+  std::string json;
+};
+
+template<typename T>
+EncodedJSON encodeJSON(const T &input) {
+  JSONWriter writer;
+  writer.value(input);
+  return EncodedJSON{ writer.release() };
+}
+
+template<> Napi::Value toNAPI<EncodedJSON>(const Napi::Env &env, const EncodedJSON &input);
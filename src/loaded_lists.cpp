@@ -0,0 +1,57 @@
+#include "loaded_lists.h"
+#include "file_hash.h"
+
+ListsLoadResult LoadedLists::load(loot::DatabaseInterface &db,
+                                  const std::filesystem::path &masterlistPath,
+                                  const std::filesystem::path &userlistPath,
+                                  const std::filesystem::path &preludePath) {
+  ListsLoadResult res;
+
+  // a file that can't be read gets an empty hash so it's always passed on, libloot reports the error
+  std::string masterlistHash = hashFile(masterlistPath).value_or("");
+  std::string preludeHash = preludePath.empty() ? "" : hashFile(preludePath).value_or("");
+
+  res.masterlist.hash = masterlistHash;
+  res.prelude.hash = preludeHash;
+  bool preludeUnchanged = preludePath.empty()
+    ? m_Prelude.path.empty()
+    : m_Prelude.matches(preludePath, preludeHash);
+  if (!m_Masterlist.matches(masterlistPath, masterlistHash) || !preludeUnchanged) {
+    // in case loading fails, what's in the database now is unknown
+    m_Masterlist = ListState{ masterlistPath, std::string(), false };
+    m_Prelude = ListState{ preludePath, std::string(), false };
+    if (preludePath.empty()) {
+      db.LoadMasterlist(masterlistPath);
+    } else {
+      db.LoadMasterlistWithPrelude(masterlistPath, preludePath);
+      res.prelude.reloaded = true;
+    }
+    res.masterlist.reloaded = true;
+    m_Masterlist = ListState{ masterlistPath, masterlistHash, false };
+    m_Prelude = ListState{ preludePath, preludeHash, false };
+  }
+
+  if (!userlistPath.empty()) {
+    std::string userlistHash = hashFile(userlistPath).value_or("");
+    res.userlist.hash = userlistHash;
+    if (!m_Userlist.matches(userlistPath, userlistHash)) {
+      m_Userlist = ListState{ userlistPath, std::string(), false };
+      db.LoadUserlist(userlistPath);
+      res.userlist.reloaded = true;
+      m_Userlist = ListState{ userlistPath, userlistHash, false };
+    }
+  }
+
+  return res;
+}
+
+std::optional<std::string> LoadedLists::contentHash() const {
+  FNV1a hash;
+  for (const ListState *list : { &m_Masterlist, &m_Prelude, &m_Userlist }) {
+    if (!list->path.empty() && list->hash.empty()) {
+      return std::nullopt;
+    }
+    hash.update(list->hash);
+  }
+  return hash.hex();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <loot/api.h>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+/**
+ * state of one of the lists after a loadLists call
+ */
+struct ListLoadStatus {
+  // false if the file was unchanged and the previously loaded data was kept
+  bool reloaded{ false };
+  // content hash of the file, empty if no file was specified
+  std::string hash;
+};
+
+struct ListsLoadResult {
+  ListLoadStatus masterlist;
+  ListLoadStatus userlist;
+  ListLoadStatus prelude;
+};
+
+/**
+ * tracks which master-/userlist (and prelude) are loaded into the database and what their content was,
+ * so loading the same files again can be skipped
+ */
+class LoadedLists {
+public:
+
+  /**
+   * load the lists that aren't loaded yet or changed. The masterlist is also reloaded when the prelude
+   * changed since the prelude is merged into it while loading.
+   * As before, an empty userlist path leaves the loaded userlist alone
+   */
+  ListsLoadResult load(loot::DatabaseInterface &db,
+                       const std::filesystem::path &masterlistPath,
+                       const std::filesystem::path &userlistPath,
+                       const std::filesystem::path &preludePath);
+
+  // the userlist in the database was changed (e.g. groups set), loading the file has to restore it
+  void userlistModified() {
+    m_Userlist.modified = true;
+  }
+
+  /**
+   * hash of the content of all lists in the database, nullopt if that isn't known (a list couldn't be read
+   * or loading failed). Changes made to the userlist after loading it aren't included
+   */
+  std::optional<std::string> contentHash() const;
+
+private:
+
+  struct ListState {
+    // a path with an empty hash means the content of the list in the database is unknown
+    std::filesystem::path path;
+    std::string hash;
+    bool modified{ false };
+
+    bool matches(const std::filesystem::path &otherPath, const std::string &otherHash) const {
+      return !hash.empty() && !modified && (path == otherPath) && (hash == otherHash);
+    }
+  };
+
+  ListState m_Masterlist;
+  ListState m_Prelude;
+  ListState m_Userlist;
+
+};
@@ -0,0 +1,183 @@
+#include "log_queue.h"
+#include <loot/api.h>
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// level at which dropped messages get reported (warning)
+static const int DROPPED_REPORT_LEVEL = 3;
+
+// queues of all open instances in the process
+static std::mutex s_OpenQueuesMutex;
+static std::vector<std::shared_ptr<LogQueue>> s_OpenQueues;
+
+// the queue of the instance whose work runs on this thread
+static thread_local std::shared_ptr<LogQueue> t_CurrentQueue;
+
+LogQueue::Scope::Scope(std::shared_ptr<LogQueue> queue)
+  : m_Previous(std::move(t_CurrentQueue))
+{
+  t_CurrentQueue = std::move(queue);
+}
+
+LogQueue::Scope::~Scope() {
+  t_CurrentQueue = std::move(m_Previous);
+}
+
+std::shared_ptr<LogQueue> LogQueue::current() {
+  return t_CurrentQueue;
+}
+
+void LogQueue::dispatch(int level, std::string_view message) {
+  if (t_CurrentQueue) {
+    t_CurrentQueue->push(level, message);
+    return;
+  }
+
+  std::vector<std::shared_ptr<LogQueue>> queues;
+  {
+    std::lock_guard<std::mutex> lock(s_OpenQueuesMutex);
+    queues = s_OpenQueues;
+  }
+  for (const auto &queue : queues) {
+    queue->push(level, message);
+  }
+}
+
+LogQueue::LogQueue(size_t capacity)
+  : m_Records(new Record[capacity])
+  , m_Mask(capacity - 1)
+{
+  for (size_t i = 0; i < capacity; ++i) {
+    m_Records[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+LogQueue::~LogQueue() {
+  close();
+}
+
+void LogQueue::open(Napi::Env env, Napi::Function callback) {
+  // the finalizer owns a reference so the queue outlives drains that are still scheduled
+  m_Callback = DrainFunction::New(env, callback, "logcb", 0, 1, this,
+                                  [](Napi::Env, std::shared_ptr<LogQueue> *self, LogQueue*) { delete self; },
+                                  new std::shared_ptr<LogQueue>(shared_from_this()));
+
+  static std::once_flag installed;
+  std::call_once(installed, []() {
+    loot::SetLoggingCallback([](loot::LogLevel level, std::string_view message) {
+      dispatch(static_cast<int>(level), message);
+    });
+  });
+
+  std::lock_guard<std::mutex> lock(s_OpenQueuesMutex);
+  s_OpenQueues.push_back(shared_from_this());
+}
+
+void LogQueue::close() {
+  if (m_Closed.exchange(true, std::memory_order_seq_cst)) {
+    return;
+  }
+
+  // producers check m_Closed after announcing themselves, once none is announced none can call m_Callback
+  while (m_Scheduling.load(std::memory_order_seq_cst) != 0) {
+    std::this_thread::yield();
+  }
+  if (static_cast<napi_threadsafe_function>(m_Callback) != nullptr) {
+    m_Callback.Release();
+  }
+
+  std::lock_guard<std::mutex> lock(s_OpenQueuesMutex);
+  s_OpenQueues.erase(std::remove_if(s_OpenQueues.begin(), s_OpenQueues.end(),
+                                    [this](const std::shared_ptr<LogQueue> &queue) { return queue.get() == this; }),
+                     s_OpenQueues.end());
+}
+
+void LogQueue::push(int level, std::string_view message) {
+  if (m_Closed.load(std::memory_order_acquire) || (level < m_MinLevel.load(std::memory_order_relaxed))) {
+    return;
+  }
+
+  // multi-producer enqueue into a bounded ring, see
+  // https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+  Record *record = nullptr;
+  size_t pos = m_EnqueuePos.load(std::memory_order_relaxed);
+  for (;;) {
+    record = &m_Records[pos & m_Mask];
+    size_t seq = record->sequence.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (m_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // full
+      m_Dropped.fetch_add(1, std::memory_order_relaxed);
+      scheduleDrain();
+      return;
+    } else {
+      pos = m_EnqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+
+  record->level = level;
+  // reuses the buffer of the record if it's large enough
+  record->message.assign(message);
+  record->sequence.store(pos + 1, std::memory_order_release);
+
+  scheduleDrain();
+}
+
+void LogQueue::scheduleDrain() {
+  if (m_DrainScheduled.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  m_Scheduling.fetch_add(1, std::memory_order_seq_cst);
+  if (!m_Closed.load(std::memory_order_seq_cst)) {
+    if (m_Callback.NonBlockingCall() != napi_ok) {
+      m_DrainScheduled.store(false, std::memory_order_release);
+    }
+  }
+  m_Scheduling.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void LogQueue::callDrain(Napi::Env env, Napi::Function jsCallback, LogQueue *queue, void*) {
+  // no environment means the function is being finalized with this drain still pending
+  if (env == nullptr) {
+    return;
+  }
+  queue->drain(env, jsCallback);
+}
+
+void LogQueue::drain(Napi::Env env, Napi::Function jsCallback) {
+  // reset before reading so that messages pushed from here on schedule another drain
+  m_DrainScheduled.exchange(false, std::memory_order_acq_rel);
+
+  uint64_t dropped = m_Dropped.load(std::memory_order_relaxed);
+  if (dropped != m_DroppedReported) {
+    std::string message = std::to_string(dropped - m_DroppedReported) + " log messages dropped because the log queue was full";
+    m_DroppedReported = dropped;
+    jsCallback.Call({ Napi::Number::New(env, DROPPED_REPORT_LEVEL), Napi::String::New(env, message) });
+  }
+
+  // limit the batch to one pass over the ring so a log storm can't starve the event loop
+  for (size_t count = 0; count <= m_Mask; ++count) {
+    Record &record = m_Records[m_DequeuePos & m_Mask];
+    size_t seq = record.sequence.load(std::memory_order_acquire);
+    if (seq != m_DequeuePos + 1) {
+      // empty
+      return;
+    }
+
+    int level = record.level;
+    Napi::String message = Napi::String::New(env, record.message);
+    record.sequence.store(m_DequeuePos + m_Mask + 1, std::memory_order_release);
+    ++m_DequeuePos;
+
+    jsCallback.Call({ Napi::Number::New(env, level), message });
+  }
+
+  scheduleDrain();
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <napi.h>
+
+/**
+ * bounded, lock-free queue carrying log messages from libloot threads to the javascript log callback.
+ * Messages below the configured level are discarded before being queued. Records and their string
+ * buffers are allocated once and reused. When the queue is full, messages are dropped and counted,
+ * the number of dropped messages is reported with the next batch.
+ * The queue is drained on the main thread in batches, at most one drain is scheduled at any time.
+ * The thread-safe function used for that keeps the queue alive until it's finalized, so a drain still
+ * scheduled when the queue is closed never refers to a destroyed queue.
+ *
+ * libloot has a single log callback for the whole process while there may be several game handles, in
+ * different threads/environments (worker mode, LootPool). The callback is installed once and passes each
+ * message to the queue of the instance working on the logging thread (see Scope). Messages logged on threads
+ * libloot starts itself can't be attributed, those go to all open queues, each applying its own level
+ */
+class LogQueue : public std::enable_shared_from_this<LogQueue> {
+public:
+
+  // capacity has to be a power of two
+  explicit LogQueue(size_t capacity = 1024);
+
+  ~LogQueue();
+
+  // start receiving libloot messages, passing them to the javascript callback. Main thread only
+  void open(Napi::Env env, Napi::Function callback);
+
+  // stop receiving messages and release the javascript callback. Has to happen before the environment
+  // the callback belongs to goes away. Safe to call more than once
+  void close();
+
+  // the queue messages logged on the current thread are attributed to, may be null
+  static std::shared_ptr<LogQueue> current();
+
+  /**
+   * attributes messages logged on the current thread to the queue while the scope exists
+   */
+  class Scope {
+  public:
+    explicit Scope(std::shared_ptr<LogQueue> queue);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope &operator=(const Scope&) = delete;
+  private:
+    std::shared_ptr<LogQueue> m_Previous;
+  };
+
+  // may be called from any thread
+  void push(int level, std::string_view message);
+
+  void setLevel(int level) {
+    m_MinLevel.store(level, std::memory_order_relaxed);
+  }
+
+  int getLevel() const {
+    return m_MinLevel.load(std::memory_order_relaxed);
+  }
+
+private:
+
+  struct Record {
+    std::atomic<size_t> sequence;
+    int level;
+    std::string message;
+  };
+
+  static void dispatch(int level, std::string_view message);
+
+  static void callDrain(Napi::Env env, Napi::Function jsCallback, LogQueue *queue, void *data);
+
+  using DrainFunction = Napi::TypedThreadSafeFunction<LogQueue, void, &LogQueue::callDrain>;
+
+  void scheduleDrain();
+
+  // main thread only
+  void drain(Napi::Env env, Napi::Function jsCallback);
+
+private:
+
+  DrainFunction m_Callback;
+  std::atomic<bool> m_Closed{ false };
+  // threads currently scheduling a drain, close() waits for them before releasing m_Callback
+  std::atomic<int> m_Scheduling{ 0 };
+  std::unique_ptr<Record[]> m_Records;
+  size_t m_Mask;
+  std::atomic<size_t> m_EnqueuePos{ 0 };
+  // only accessed by the consumer on the main thread
+  size_t m_DequeuePos{ 0 };
+  std::atomic<bool> m_DrainScheduled{ false };
+  std::atomic<int> m_MinLevel{ 0 };
+  std::atomic<uint64_t> m_Dropped{ 0 };
+  uint64_t m_DroppedReported{ 0 };
+
+};
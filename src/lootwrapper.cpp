@@ -3,6 +3,7 @@
 
 #include <map>
 #include <future>
+#include <variant>
 #include <sstream>
 #include <memory>
 #include <iostream>
@@ -15,99 +16,15 @@
 #include "string_cast.h"
 #include "util.h"
 #include "napi_helpers.h"
-
-template<>
-Napi::Value toNAPI<loot::Tag>(const Napi::Env &env, const loot::Tag &input) {
-  Napi::Object res = Napi::Object::New(env);
-  res.Set("condition", input.GetCondition());
-  res.Set("name", input.GetName());
-  res.Set("isAddition", input.IsAddition());
-
-  return res;
-}
-
-template<>
-Napi::Value toNAPI<loot::MessageContent>(const Napi::Env &env, const loot::MessageContent &input) {
-  Napi::Object res = Napi::Object::New(env);
-
-  res.Set("text", input.GetText());
-  res.Set("language", input.GetLanguage());
-
-  return res;
-}
-
-template<>
-Napi::Value toNAPI<loot::Message>(const Napi::Env &env, const loot::Message &input) {
-  Napi::Object res = Napi::Object::New(env);
-  res.Set("condition", input.GetCondition());
-  res.Set("content", toNAPI(env, input.GetContent()));
-  res.Set("type", static_cast<unsigned int>(input.GetType()));
-
-  return res;
-}
-
-template<>
-Napi::Value toNAPI<loot::PluginCleaningData>(const Napi::Env &env, const loot::PluginCleaningData &input) {
-  Napi::Object res = Napi::Object::New(env);
-  res.Set("cleaningUtility", input.GetCleaningUtility());
-  res.Set("crc", input.GetCRC());
-  res.Set("deletedNavmeshCount", input.GetDeletedNavmeshCount());
-  res.Set("deletedReferenceCount", input.GetDeletedReferenceCount());
-  // res.Set("info", toNAPI(env, input.GetInfo()));
-  res.Set("itmCount", input.GetITMCount());
-
-  return res;
-}
-
-template<>
-Napi::Value toNAPI<loot::File>(const Napi::Env &env, const loot::File &input) {
-  Napi::Object res = Napi::Object::New(env);
-  res.Set("condition", input.GetCondition());
-  res.Set("displayName", input.GetDisplayName());
-  res.Set("name", static_cast<std::string>(input.GetName()));
-
-  return res;
-}
-
-template<>
-Napi::Value toNAPI<loot::Location>(const Napi::Env &env, const loot::Location &input) {
-  Napi::Object res = Napi::Object::New(env);
-  res.Set("name", input.GetName());
-  res.Set("url", input.GetURL());
-
-  return res;
-}
-
-template<>
-Napi::Value toNAPI<loot::Vertex>(const Napi::Env &env, const loot::Vertex &input) {
-  Napi::Object res = Napi::Object::New(env);
-
-  res.Set("name", input.GetName());
-  auto edgeType = input.GetTypeOfEdgeToNextVertex();
-  res.Set("typeOfEdgeToNextVertex", edgeType.has_value() ? convertEdgeType(edgeType.value()) : "");
-
-  return res;
-}
-
-template<>
-Napi::Value toNAPI<loot::Group>(const Napi::Env &env, const loot::Group &input) {
-  Napi::Object res = Napi::Object::New(env);
-
-  res.Set("afterGroups", toNAPI(env, input.GetAfterGroups()));
-  res.Set("description", input.GetDescription());
-  res.Set("name", input.GetName());
-
-  return res;
-}
-
-template<>
-loot::Group fromNAPI(const Napi::Value &info) {
-  Napi::Object obj = info.As<Napi::Object>();
-  return loot::Group(
-    obj.Get("name").ToString().Utf8Value(),
-    fromNAPIArr<std::string>(obj.Get("afterGroups")),
-    obj.Get("description").ToString().Utf8Value());
-}
+#include "converters.h"
+#include "json_encoder.h"
+#include "log_queue.h"
+#include "metadata_handle.h"
+#include "plugin_fingerprints.h"
+#include "shared_region.h"
+#include "snapshot.h"
+#include "thread_pool.h"
+#include "addon_data.h"
 
 loot::GameType convertGameId(const Napi::Env &env, const std::string &gameId) {
   std::map<std::string, loot::GameType> gameMap{
@@ -131,9 +48,144 @@ loot::GameType convertGameId(const Napi::Env &env, const std::string &gameId) {
   return iter->second;
 }
 
+// below this number of plugins per batch, handing the batch to another thread costs more than it saves
+static const size_t METADATA_MIN_BATCH_SIZE = 64;
+
+/**
+ * look up the metadata for several plugins at once, the result has one entry per input plugin, in the
+ * same order.
+ * Lookups without condition evaluation are spread across the thread pool. Evaluating conditions reads and
+ * writes libloot's condition cache and libloot doesn't promise that's safe from several threads at once,
+ * so those lookups are made one after the other
+ */
+std::vector<std::optional<loot::PluginMetadata>> getMetadataParallel(const loot::DatabaseInterface &db,
+                                                                      const std::vector<std::string> &pluginNames,
+                                                                      bool includeUserMetadata,
+                                                                      bool evaluateConditions) {
+  std::vector<std::optional<loot::PluginMetadata>> result(pluginNames.size());
+
+  if (evaluateConditions) {
+    for (size_t i = 0; i < pluginNames.size(); ++i) {
+      result[i] = db.GetPluginMetadata(pluginNames[i], includeUserMetadata, true);
+    }
+    return result;
+  }
+
+  // without evaluation this only reads the loaded lists through the const interface, no cache is involved
+  std::shared_ptr<LogQueue> logQueue = LogQueue::current();
+  ThreadPool::instance().parallelFor(pluginNames.size(), METADATA_MIN_BATCH_SIZE, [&](size_t begin, size_t end) {
+    LogQueue::Scope logScope(logQueue);
+    for (size_t i = begin; i < end; ++i) {
+      result[i] = db.GetPluginMetadata(pluginNames[i], includeUserMetadata, false);
+    }
+  });
+  return result;
+}
+
+// the files the conditions of the plugin's metadata refer to. Takes the metadata without evaluated
+// conditions, the evaluated one lacks the entries whose conditions didn't apply and the files those
+// refer to matter just as much
+ConditionPaths conditionDependencies(const std::string &pluginName,
+                                     const std::optional<loot::PluginMetadata> &rawMetadata) {
+  ConditionPaths res;
+  res.addPath(pluginName);
+  if (rawMetadata.has_value()) {
+    res.addMetadata(*rawMetadata);
+  }
+  return res;
+}
+
+/**
+ * turn an exception caught while running a libloot call into the same error the synchronous
+ * variant of the call would have thrown
+ */
+Napi::Error convertException(const Napi::Env &env, const char *func, std::exception_ptr ex,
+                             const std::optional<std::vector<std::unique_ptr<const loot::PluginInterface>>> &currentlyLoaded) {
+  try {
+    std::rethrow_exception(ex);
+  } catch (const Napi::Error &e) {
+    return e;
+  } catch (loot::CyclicInteractionError &e) {
+    return CyclicalInteractionException(env, e);
+  } catch (const std::filesystem::filesystem_error &e) {
+    return ErrnoException(env, e.code().value(), func, reinterpret_cast<const char*>(e.path1().generic_u8string().c_str()));
+  } catch (const loot::PluginNotLoadedError &e) {
+    return PluginNotLoaded(env, func, e.what(), currentlyLoaded);
+  } catch (const std::exception &e) {
+    return LOOTError(env, func, e.what());
+  } catch (...) {
+    return Napi::Error::New(env, "unknown exception");
+  }
+}
+
+/**
+ * runs a libloot call on the libuv threadpool and settles a promise with the result once it's done.
+ * The result is only converted to javascript types on the main thread
+ */
+template<typename ResultT>
+class LootWorker : public Napi::AsyncWorker {
+public:
+  LootWorker(const Napi::Env &env, Loot *loot, const Napi::Object &self, const char *func, std::function<ResultT()> work)
+    : Napi::AsyncWorker(env, func)
+    , m_Deferred(Napi::Promise::Deferred::New(env))
+    , m_Self(Napi::Persistent(self))
+    , m_Loot(loot)
+    , m_Func(func)
+    , m_Work(std::move(work))
+  {
+  }
+
+  Napi::Promise GetPromise() const {
+    return m_Deferred.Promise();
+  }
+
+protected:
+
+  void Execute() override {
+    LogQueue::Scope logScope(m_Loot->m_LogQueue);
+    try {
+      m_Result = m_Work();
+    } catch (const loot::PluginNotLoadedError&) {
+      m_Exception = std::current_exception();
+      try {
+        m_CurrentlyLoaded = m_Loot->m_Game->GetLoadedPlugins();
+      } catch (...) {
+      }
+    } catch (...) {
+      m_Exception = std::current_exception();
+    }
+  }
+
+  void OnOK() override {
+    Napi::Env env = Env();
+    if (m_Exception) {
+      m_Deferred.Reject(convertException(env, m_Func, m_Exception, m_CurrentlyLoaded).Value());
+    } else {
+      try {
+        m_Deferred.Resolve(toNAPI(env, m_Result));
+      } catch (...) {
+        m_Deferred.Reject(convertException(env, m_Func, std::current_exception(), std::nullopt).Value());
+      }
+    }
+    m_Loot->workFinished();
+  }
+
+private:
+
+  Napi::Promise::Deferred m_Deferred;
+  // keeps the Loot object alive until the work is done
+  Napi::ObjectReference m_Self;
+  Loot *m_Loot;
+  const char *m_Func;
+  std::function<ResultT()> m_Work;
+  ResultT m_Result;
+  std::exception_ptr m_Exception;
+  std::optional<std::vector<std::unique_ptr<const loot::PluginInterface>>> m_CurrentlyLoaded;
+};
+
 Loot::Loot(const Napi::CallbackInfo &info)
   : Napi::ObjectWrap<Loot>(info)
-  , m_LogCallback(Napi::ThreadSafeFunction::New(info.Env(), info[4].As<Napi::Function>(), "logcb", 0, 1))
+  , m_LogQueue(std::make_shared<LogQueue>())
 {
   std::string game, language;
   std::wstring gamePath, gameLocalPath;
@@ -141,72 +193,203 @@ Loot::Loot(const Napi::CallbackInfo &info)
 
   m_Language = language;
 
-  try {
-    // logging is a bit complex I'm afraid because loot logs messages from different threads and we can only invoke
-    // the js callback from the main process.
-    // Napi::ThreadSafeFunction helps with that. From the thread we invoke the ThreadSafeFunction which transfers the log
-    // message in a C++ object via queue to the main thread where this mainThreadCB is invoked which then invokes the
-    // javascript callback
-
-    auto mainThreadCB = [](Napi::Env env, Napi::Function jsCallback, std::tuple<int, std::string> *value) {
-      jsCallback.Call({ Napi::Number::New(env, std::get<0>(*value)), Napi::String::New(env, std::get<1>(*value)) });
-    };
-
-    loot::SetLoggingCallback([&info, this, mainThreadCB](loot::LogLevel level, std::string_view message) {
-      auto data = new std::tuple(static_cast<int>(level), std::string(message));
-      this->m_LogCallback.BlockingCall(data, mainThreadCB);
-    });
-
+  // logging is a bit complex I'm afraid because loot logs messages from different threads and we can only invoke
+  // the js callback from the main process.
+  // The messages are put into a lock-free queue which gets drained on the main thread through a
+  // Napi::ThreadSafeFunction. Pushing never blocks the logging thread, if the queue is full the message is dropped.
+  // The queue has to be closed before the environment goes away (e.g. a worker thread ending), whichever
+  // comes first of this object being destroyed and the environment cleanup
+  m_LogQueue->open(info.Env(), info[4].As<Napi::Function>());
+  napi_add_env_cleanup_hook(info.Env(), closeLogQueue, m_LogQueue.get());
+  LogQueue::Scope logScope(m_LogQueue);
 
+  try {
     auto gameId = convertGameId(info.Env(), game);
     m_Game = loot::CreateGameHandle(gameId, std::filesystem::path(gamePath), std::filesystem::path(gameLocalPath));
+    m_PluginFingerprints = std::make_unique<PluginFingerprints>(gameId, std::filesystem::path(gamePath));
   } catch (const std::filesystem::filesystem_error &e) {
+    // the destructor doesn't run if the constructor throws
+    stopLogging(info.Env());
     throw ErrnoException(info.Env(), e.code().value(), __FUNCTION__, reinterpret_cast<const char*>(e.path1().generic_u8string().c_str()));
   } catch (const std::exception &e) {
+    stopLogging(info.Env());
     throw ExcWrap(info.Env(), __FUNCTION__, e);
   }
   catch (...) {
+    stopLogging(info.Env());
     napi_throw_error(info.Env(), "UNKNOWN", "unknown exception");
   }
 }
 
+Loot::~Loot() {
+  stopLogging(Env());
+}
 
-Napi::Value Loot::loadLists(const Napi::CallbackInfo &info) {
+void Loot::closeLogQueue(void *queue) {
+  static_cast<LogQueue*>(queue)->close();
+}
+
+void Loot::stopLogging(napi_env env) {
+  napi_remove_env_cleanup_hook(env, closeLogQueue, m_LogQueue.get());
+  m_LogQueue->close();
+}
+
+ListsLoadResult Loot::loadListsImpl(const std::wstring &masterlistPath, const std::wstring &userlistPath,
+                                    const std::wstring &preludePath) {
   /*
    * As of libloot 0.26.0 the loadLists function has been split into
    * loadMasterlist, loadMasterlistWithPrelude and loadUserlist.
    * We're going to consolidate both calls in this function for now.
   */
-  std::wstring masterlistPath, userlistPath, preludePath;
-  unpackArgs(info, masterlistPath, userlistPath, preludePath);
+  ListsLoadResult res;
+  try {
+    res = m_LoadedLists.load(m_Game->GetDatabase(), masterlistPath, userlistPath, preludePath);
+  } catch (...) {
+    m_MetadataCache.invalidate();
+    throw;
+  }
+  if (res.masterlist.reloaded || res.userlist.reloaded || res.prelude.reloaded) {
+    m_MetadataCache.invalidate();
+  }
+  return res;
+}
 
+IncrementalLoadResult Loot::loadPluginsIncremental(const std::vector<std::string> &plugins, bool headersOnly) {
+  IncrementalLoadResult res;
   try {
-    loot::DatabaseInterface &db = m_Game->GetDatabase();
-    if (preludePath.empty()) {
-      db.LoadMasterlist(masterlistPath);
+    res = m_PluginFingerprints->load(*m_Game, plugins, headersOnly);
+  } catch (...) {
+    m_MetadataCache.invalidateConditional();
+    throw;
+  }
+  // if nothing was parsed, the state conditions are evaluated against is the same
+  if (res.reloadedAll || !res.loaded.empty()) {
+    m_MetadataCache.invalidateConditional();
+  }
+  return res;
+}
+
+std::optional<loot::PluginMetadata> Loot::getMetadataImpl(const std::string &pluginName, bool includeUserMetadata,
+                                                          bool evaluateConditions) {
+  const std::optional<loot::PluginMetadata> *cached = m_MetadataCache.find(pluginName, includeUserMetadata, evaluateConditions);
+  if (cached != nullptr) {
+    return *cached;
+  }
+  if (!evaluateConditions) {
+    return rawMetadata(pluginName, includeUserMetadata);
+  }
+  ConditionPaths dependencies = conditionDependencies(pluginName, rawMetadata(pluginName, includeUserMetadata));
+  std::optional<loot::PluginMetadata> res = m_Game->GetDatabase().GetPluginMetadata(pluginName, includeUserMetadata, true);
+  m_MetadataCache.store(pluginName, includeUserMetadata, true, res, std::move(dependencies));
+  return res;
+}
+
+const std::optional<loot::PluginMetadata> &Loot::rawMetadata(const std::string &pluginName, bool includeUserMetadata) {
+  const std::optional<loot::PluginMetadata> *cached = m_MetadataCache.peek(pluginName, includeUserMetadata, false);
+  if (cached == nullptr) {
+    m_MetadataCache.store(pluginName, includeUserMetadata, false,
+                          m_Game->GetDatabase().GetPluginMetadata(pluginName, includeUserMetadata, false));
+    cached = m_MetadataCache.peek(pluginName, includeUserMetadata, false);
+  }
+  return *cached;
+}
+
+std::vector<std::optional<loot::PluginMetadata>> Loot::getMetadataListImpl(const std::vector<std::string> &pluginNames,
+                                                                           bool includeUserMetadata,
+                                                                           bool evaluateConditions) {
+  std::vector<std::optional<loot::PluginMetadata>> res(pluginNames.size());
+
+  // only the plugins not cached are looked up
+  std::vector<size_t> missingIndices;
+  std::vector<std::string> missingNames;
+  for (size_t i = 0; i < pluginNames.size(); ++i) {
+    const std::optional<loot::PluginMetadata> *cached = m_MetadataCache.find(pluginNames[i], includeUserMetadata, evaluateConditions);
+    if (cached != nullptr) {
+      res[i] = *cached;
     } else {
-      db.LoadMasterlistWithPrelude(masterlistPath, preludePath);
+      missingIndices.push_back(i);
+      missingNames.push_back(pluginNames[i]);
+    }
+  }
+
+  if (missingNames.empty()) {
+    return res;
+  }
+
+  if (!evaluateConditions) {
+    std::vector<std::optional<loot::PluginMetadata>> fetched = getMetadataParallel(m_Game->GetDatabase(), missingNames, includeUserMetadata, false);
+    for (size_t i = 0; i < missingIndices.size(); ++i) {
+      m_MetadataCache.store(missingNames[i], includeUserMetadata, false, fetched[i]);
+      res[missingIndices[i]] = std::move(fetched[i]);
     }
-    if (!userlistPath.empty()) {
-      db.LoadUserlist(userlistPath);
+    return res;
+  }
+
+  // the unevaluated metadata the dependencies are collected from is looked up (unless cached already) and
+  // scanned in the same parallel batches, only the evaluation itself has to run serially.
+  // The cache isn't modified until the batches are done so the cached pointers stay valid
+  std::vector<const std::optional<loot::PluginMetadata>*> cachedRaw(missingNames.size());
+  for (size_t i = 0; i < missingNames.size(); ++i) {
+    cachedRaw[i] = m_MetadataCache.peek(missingNames[i], includeUserMetadata, false);
+  }
+  std::vector<std::optional<loot::PluginMetadata>> fetchedRaw(missingNames.size());
+  std::vector<ConditionPaths> dependencies(missingNames.size());
+
+  const loot::DatabaseInterface &db = m_Game->GetDatabase();
+  std::shared_ptr<LogQueue> logQueue = LogQueue::current();
+  ThreadPool::instance().parallelFor(missingNames.size(), METADATA_MIN_BATCH_SIZE, [&](size_t begin, size_t end) {
+    LogQueue::Scope logScope(logQueue);
+    for (size_t i = begin; i < end; ++i) {
+      if (cachedRaw[i] == nullptr) {
+        fetchedRaw[i] = db.GetPluginMetadata(missingNames[i], includeUserMetadata, false);
+      }
+      dependencies[i] = conditionDependencies(missingNames[i], cachedRaw[i] != nullptr ? *cachedRaw[i] : fetchedRaw[i]);
     }
+  });
+
+  for (size_t i = 0; i < missingNames.size(); ++i) {
+    if (cachedRaw[i] == nullptr) {
+      m_MetadataCache.store(missingNames[i], includeUserMetadata, false, fetchedRaw[i]);
+    }
+  }
+
+  std::vector<std::optional<loot::PluginMetadata>> fetched = getMetadataParallel(db, missingNames, includeUserMetadata, true);
+  for (size_t i = 0; i < missingIndices.size(); ++i) {
+    m_MetadataCache.store(missingNames[i], includeUserMetadata, true, fetched[i], std::move(dependencies[i]));
+    res[missingIndices[i]] = std::move(fetched[i]);
+  }
+  return res;
+}
+
+Napi::Value Loot::loadLists(const Napi::CallbackInfo &info) {
+  std::wstring masterlistPath, userlistPath, preludePath;
+  unpackArgs(info, masterlistPath, userlistPath, preludePath);
+  LogQueue::Scope logScope = checkIdle(info.Env());
+
+  try {
+    return toNAPI(info.Env(), loadListsImpl(masterlistPath, userlistPath, preludePath));
   } catch (const std::filesystem::filesystem_error &e) {
     throw ErrnoException(info.Env(), e.code().value(), __FUNCTION__, reinterpret_cast<const char*>(e.path1().generic_u8string().c_str()));
   } catch (const std::exception &e) {
     throw LOOTError(info.Env(), "loadLists", e.what());
   }
-  return info.Env().Undefined();
 }
 
 Napi::Value Loot::loadPlugins(const Napi::CallbackInfo &info) {
   std::vector<std::string> plugins;
-  bool headersOnly;
-  unpackArgs(info, plugins, headersOnly);
-  std::vector<std::filesystem::path> pluginPaths;
-  std::transform(plugins.begin(), plugins.end(), std::back_inserter(pluginPaths), [](const std::string& str) {
-    return std::filesystem::path(str);
-  });
+  bool headersOnly, incremental = false;
+  unpackArgs<2>(info, plugins, headersOnly, incremental);
+  LogQueue::Scope logScope = checkIdle(info.Env());
   try {
+    if (incremental) {
+      return toNAPI(info.Env(), loadPluginsIncremental(plugins, headersOnly));
+    }
+    std::vector<std::filesystem::path> pluginPaths;
+    std::transform(plugins.begin(), plugins.end(), std::back_inserter(pluginPaths), [](const std::string& str) {
+      return std::filesystem::path(str);
+    });
+    m_PluginFingerprints->clear();
+    m_MetadataCache.invalidateConditional();
     m_Game->LoadPlugins(pluginPaths, headersOnly);
   } catch (const std::filesystem::filesystem_error &e) {
     throw ErrnoException(info.Env(), e.code().value(), __FUNCTION__, reinterpret_cast<const char*>(e.path1().generic_u8string().c_str()));
@@ -218,29 +401,18 @@ Napi::Value Loot::loadPlugins(const Napi::CallbackInfo &info) {
 
 Napi::Value Loot::getPluginMetadata(const Napi::CallbackInfo &info) {
   std::string pluginName;
-  bool includeUserMetadata = true, evaluateConditions = true;
-  unpackArgs<1>(info, pluginName, includeUserMetadata, evaluateConditions);
+  bool includeUserMetadata = true, evaluateConditions = true, lazy = false;
+  unpackArgs<1>(info, pluginName, includeUserMetadata, evaluateConditions, lazy);
+  LogQueue::Scope logScope = checkIdle(info.Env());
 
   try {
-    Napi::Value res = Napi::Object::New(info.Env());
-
-    std::optional<loot::PluginMetadata> meta = m_Game->GetDatabase().GetPluginMetadata(pluginName, includeUserMetadata, evaluateConditions);
-    if (meta.has_value()) {
-      // previously throw an exception here but this is *not* an error, it happens for all plugins
-      // that have no data
-      Napi::Object res = Napi::Object::New(info.Env());
-      res.Set("cleanInfo", toNAPI(info.Env(), meta->GetCleanInfo()));
-      res.Set("dirtyInfo", toNAPI(info.Env(), meta->GetDirtyInfo()));
-      res.Set("group", meta->GetGroup().value_or(""));
-      res.Set("incompatibilities", toNAPI(info.Env(), meta->GetIncompatibilities()));
-      res.Set("loadAfterFiles", toNAPI(info.Env(), meta->GetLoadAfterFiles()));
-      res.Set("locations", toNAPI(info.Env(), meta->GetLocations()));
-      res.Set("messages", toNAPI(info.Env(), meta->GetMessages()));
-      res.Set("name", meta->GetName());
-      res.Set("requirements", toNAPI(info.Env(), meta->GetRequirements()));
-      res.Set("tags", toNAPI(info.Env(), meta->GetTags()));
-      return res;
+    // previously throw an exception here if there was no metadata but this is *not* an error,
+    // it happens for all plugins that have no data
+    std::optional<loot::PluginMetadata> meta = getMetadataImpl(pluginName, includeUserMetadata, evaluateConditions);
+    if (lazy) {
+      return toNAPI(info.Env(), LazyPluginMetadata{ std::move(meta) });
     }
+    return toNAPI(info.Env(), meta);
   } catch (const std::filesystem::filesystem_error &e) {
     throw ErrnoException(info.Env(), e.code().value(), __FUNCTION__, reinterpret_cast<const char*>(e.path1().generic_u8string().c_str()));
   } catch (const std::exception &e) {
@@ -250,37 +422,28 @@ Napi::Value Loot::getPluginMetadata(const Napi::CallbackInfo &info) {
   return info.Env().Undefined();
 }
 
+Napi::Value Loot::getPluginsMetadata(const Napi::CallbackInfo &info) {
+  std::vector<std::string> pluginNames;
+  bool includeUserMetadata = true, evaluateConditions = true;
+  unpackArgs<1>(info, pluginNames, includeUserMetadata, evaluateConditions);
+  LogQueue::Scope logScope = checkIdle(info.Env());
+
+  try {
+    return toNAPI(info.Env(), getMetadataListImpl(pluginNames, includeUserMetadata, evaluateConditions));
+  } catch (const std::filesystem::filesystem_error &e) {
+    throw ErrnoException(info.Env(), e.code().value(), __FUNCTION__, reinterpret_cast<const char*>(e.path1().generic_u8string().c_str()));
+  } catch (const std::exception &e) {
+    throw LOOTError(info.Env(), "getPluginsMetadata", e.what());
+  }
+}
+
 Napi::Value Loot::getPlugin(const Napi::CallbackInfo &info) {
   std::string pluginName;
   unpackArgs(info, pluginName);
+  LogQueue::Scope logScope = checkIdle(info.Env());
 
   try {
-    auto plugin = m_Game->GetPlugin(pluginName);
-    if (plugin == nullptr) {
-      return info.Env().Undefined();
-    }
-
-    Napi::Object res = Napi::Object::New(info.Env());
-    res.Set("bashTags", toNAPI(info.Env(), plugin->GetBashTags()));
-    auto crc = plugin->GetCRC();
-    res.Set("crc", crc.has_value() ? Napi::Value::From(info.Env(), crc.value()) : info.Env().Null());
-    auto headerVersion = plugin->GetHeaderVersion();
-    res.Set("headerVersion", headerVersion.has_value() ? Napi::Value::From(info.Env(), headerVersion.value()) : info.Env().Null());
-    res.Set("masters", toNAPI(info.Env(), plugin->GetMasters()));
-    res.Set("name", plugin->GetName());
-    auto version = plugin->GetVersion();
-    res.Set("version", version.has_value() ? Napi::Value::From(info.Env(), version.value()) : (info.Env().Null()));
-    res.Set("isEmpty", plugin->IsEmpty());
-    res.Set("IsUpdatePlugin", plugin->IsUpdatePlugin());
-    res.Set("isLightPlugin", plugin->IsLightPlugin());
-    res.Set("IsMediumPlugin", plugin->IsMediumPlugin());
-    res.Set("IsBlueprintPlugin", plugin->IsBlueprintPlugin());
-    res.Set("isMaster", plugin->IsMaster());
-    res.Set("IsValidAsMediumPlugin", plugin->IsValidAsMediumPlugin());
-    res.Set("isValidAsLightPlugin", plugin->IsValidAsLightPlugin());
-    res.Set("IsValidAsUpdatePlugin", plugin->IsValidAsUpdatePlugin());
-    res.Set("loadsArchive", plugin->LoadsArchive());
-    return res;
+    return toNAPI(info.Env(), m_Game->GetPlugin(pluginName));
   } catch (const std::filesystem::filesystem_error &e) {
     throw ErrnoException(info.Env(), e.code().value(), __FUNCTION__, reinterpret_cast<const char*>(e.path1().generic_u8string().c_str()));
   } catch (const loot::PluginNotLoadedError &e) {
@@ -291,11 +454,21 @@ Napi::Value Loot::getPlugin(const Napi::CallbackInfo &info) {
   return info.Env().Undefined();
 }
 
+Napi::Value Loot::getPluginsSnapshot(const Napi::CallbackInfo &info) {
+  LogQueue::Scope logScope = checkIdle(info.Env());
+  try {
+    return toNAPI(info.Env(), createPluginsSnapshot(*m_Game));
+  } catch (const std::exception &e) {
+    throw LOOTError(info.Env(), "getPluginsSnapshot", e.what());
+  }
+}
+
 Napi::Value Loot::sortPlugins(const Napi::CallbackInfo &info) {
   std::vector<std::string> plugins;
   unpackArgs(info, plugins);
+  LogQueue::Scope logScope = checkIdle(info.Env());
   try {
-    return toNAPI(info.Env(), m_Game->SortPlugins(plugins));
+    return toNAPI(info.Env(), sortPluginsImpl(plugins));
   } catch (loot::CyclicInteractionError &e) {
     throw CyclicalInteractionException(info.Env(), e);
   } catch (const std::filesystem::filesystem_error &e) {
@@ -307,11 +480,45 @@ Napi::Value Loot::sortPlugins(const Napi::CallbackInfo &info) {
   }
 }
 
+std::vector<std::string> Loot::sortPluginsImpl(const std::vector<std::string> &plugins) {
+  std::optional<std::string> digest;
+  if (m_SortCache.enabled()) {
+    digest = m_SortCache.digest(*m_Game, m_LoadedLists, plugins);
+    if (digest.has_value()) {
+      std::optional<std::vector<std::string>> cached = m_SortCache.get(*digest, plugins);
+      if (cached.has_value()) {
+        return *cached;
+      }
+    }
+  }
+
+  std::vector<std::string> res = m_Game->SortPlugins(plugins);
+  if (digest.has_value()) {
+    m_SortCache.put(*digest, res);
+  }
+  return res;
+}
+
+Napi::Value Loot::setSortCache(const Napi::CallbackInfo &info) {
+  std::wstring directory;
+  unpackArgs(info, directory);
+  LogQueue::Scope logScope = checkIdle(info.Env());
+
+  try {
+    m_SortCache.setDirectory(directory);
+  } catch (const std::filesystem::filesystem_error &e) {
+    throw ErrnoException(info.Env(), e.code().value(), __FUNCTION__, reinterpret_cast<const char*>(e.path1().generic_u8string().c_str()));
+  }
+  return info.Env().Undefined();
+}
+
 Napi::Value Loot::setLoadOrder(const Napi::CallbackInfo &info) {
   std::vector<std::string> plugins;
   unpackArgs(info, plugins);
+  LogQueue::Scope logScope = checkIdle(info.Env());
 
   try {
+    m_MetadataCache.invalidateConditional();
     m_Game->SetLoadOrder(plugins);
     return info.Env().Undefined();
   } catch (const std::exception &e) {
@@ -320,6 +527,7 @@ Napi::Value Loot::setLoadOrder(const Napi::CallbackInfo &info) {
 }
 
 Napi::Value Loot::getLoadOrder(const Napi::CallbackInfo &info) {
+  LogQueue::Scope logScope = checkIdle(info.Env());
   try {
     return toNAPI(info.Env(), m_Game->GetLoadOrder());
   } catch (const std::exception &e) {
@@ -328,7 +536,9 @@ Napi::Value Loot::getLoadOrder(const Napi::CallbackInfo &info) {
 }
 
 Napi::Value Loot::loadCurrentLoadOrderState(const Napi::CallbackInfo &info) {
+  LogQueue::Scope logScope = checkIdle(info.Env());
   try {
+    m_MetadataCache.invalidateConditional();
     m_Game->LoadCurrentLoadOrderState();
   } catch (const std::exception &e) {
     throw LOOTError(info.Env(), "loadCurrentLoadOrderState", e.what());
@@ -339,6 +549,7 @@ Napi::Value Loot::loadCurrentLoadOrderState(const Napi::CallbackInfo &info) {
 Napi::Value Loot::isPluginActive(const Napi::CallbackInfo &info) {
   std::string pluginName;
   unpackArgs(info, pluginName);
+  LogQueue::Scope logScope = checkIdle(info.Env());
 
   try {
     return Napi::Boolean::New(info.Env(), m_Game->IsPluginActive(pluginName));
@@ -350,6 +561,7 @@ Napi::Value Loot::isPluginActive(const Napi::CallbackInfo &info) {
 Napi::Value Loot::getGroups(const Napi::CallbackInfo &info) {
   bool includeUserGroups;
   unpackArgs(info, includeUserGroups);
+  LogQueue::Scope logScope = checkIdle(info.Env());
 
   try {
     return toNAPI(info.Env(), m_Game->GetDatabase().GetGroups(includeUserGroups));
@@ -359,6 +571,7 @@ Napi::Value Loot::getGroups(const Napi::CallbackInfo &info) {
 }
 
 Napi::Value Loot::getUserGroups(const Napi::CallbackInfo &info) {
+  LogQueue::Scope logScope = checkIdle(info.Env());
   try {
     return toNAPI(info.Env(), m_Game->GetDatabase().GetUserGroups());
   } catch (const std::exception &e) {
@@ -369,8 +582,11 @@ Napi::Value Loot::getUserGroups(const Napi::CallbackInfo &info) {
 Napi::Value Loot::setUserGroups(const Napi::CallbackInfo &info) {
   std::vector<loot::Group> groups;
   unpackArgs(info, groups);
+  LogQueue::Scope logScope = checkIdle(info.Env());
 
   try {
+    m_LoadedLists.userlistModified();
+    m_MetadataCache.invalidate();
     m_Game->GetDatabase().SetUserGroups(groups);
     return info.Env().Undefined();
   } catch (const std::exception &e) {
@@ -381,6 +597,7 @@ Napi::Value Loot::setUserGroups(const Napi::CallbackInfo &info) {
 Napi::Value Loot::getGroupsPath(const Napi::CallbackInfo &info) {
   std::string fromGroupName, toGroupName;
   unpackArgs(info, fromGroupName, toGroupName);
+  LogQueue::Scope logScope = checkIdle(info.Env());
 
   try {
     return toNAPI(info.Env(), m_Game->GetDatabase().GetGroupsPath(fromGroupName, toGroupName));
@@ -392,6 +609,7 @@ Napi::Value Loot::getGroupsPath(const Napi::CallbackInfo &info) {
 Napi::Value Loot::getGeneralMessages(const Napi::CallbackInfo &info) {
   bool evaluateConditions;
   unpackArgs(info, evaluateConditions);
+  LogQueue::Scope logScope = checkIdle(info.Env());
 
   try {
     return toNAPI(info.Env(), m_Game->GetDatabase().GetGeneralMessages(true, evaluateConditions));
@@ -401,14 +619,358 @@ Napi::Value Loot::getGeneralMessages(const Napi::CallbackInfo &info) {
 }
 
 Napi::Value Loot::clearConditionCache(const Napi::CallbackInfo &info) {
+  LogQueue::Scope logScope = checkIdle(info.Env());
   try {
+    m_MetadataCache.invalidateConditional();
     m_Game->GetDatabase().ClearConditionCache();
+    m_SortCache.clear();
   } catch (const std::exception &e) {
     throw LOOTError(info.Env(), "clearConditionCache", e.what());
   }
   return info.Env().Undefined();
 }
 
+Napi::Value Loot::invalidateConditionsForPaths(const Napi::CallbackInfo &info) {
+  std::vector<std::string> paths;
+  unpackArgs(info, paths);
+  LogQueue::Scope logScope = checkIdle(info.Env());
+  try {
+    return toNAPI(info.Env(), invalidateConditionsImpl(paths));
+  } catch (const std::exception &e) {
+    throw LOOTError(info.Env(), "invalidateConditionsForPaths", e.what());
+  }
+}
+
+std::vector<std::string> Loot::toConditionPaths(const std::vector<std::string> &paths) const {
+  std::vector<std::filesystem::path> additionalPaths = m_Game->GetAdditionalDataPaths();
+  std::vector<std::string> res;
+  auto add = [&res](const std::filesystem::path &path) {
+    res.push_back(normalizeConditionPath(reinterpret_cast<const char*>(path.generic_u8string().c_str())));
+  };
+
+  for (const auto &input : paths) {
+    std::filesystem::path path(reinterpret_cast<const char8_t*>(input.c_str()));
+    if (!path.is_absolute()) {
+      add(path);
+      continue;
+    }
+    // files outside the data directory are referred to relative to it, e.g. ../game.exe
+    std::filesystem::path relative = path.lexically_relative(m_PluginFingerprints->pluginsPath());
+    if (!relative.empty()) {
+      add(relative);
+    }
+    // conditions are also evaluated against the additional data paths
+    for (const auto &dataPath : additionalPaths) {
+      relative = path.lexically_relative(dataPath);
+      if (!relative.empty() && (*relative.begin() != "..")) {
+        add(relative);
+      }
+    }
+  }
+  return res;
+}
+
+uint32_t Loot::invalidateConditionsImpl(const std::vector<std::string> &paths) {
+  uint32_t res = static_cast<uint32_t>(m_MetadataCache.invalidateForPaths(toConditionPaths(paths)));
+  // libloot can only forget all condition results. Cached metadata that doesn't depend on the files stays
+  // valid, it just doesn't have to be evaluated again
+  m_Game->GetDatabase().ClearConditionCache();
+  // which files the sort results depend on isn't recorded, any of them may be affected
+  if (!paths.empty()) {
+    m_SortCache.clear();
+  }
+  return res;
+}
+
+template<typename ResultT>
+Napi::Value Loot::queueWork(const Napi::CallbackInfo &info, const char *func, std::function<ResultT()> work) {
+  auto worker = new LootWorker<ResultT>(info.Env(), this, info.This().As<Napi::Object>(), func, std::move(work));
+  Napi::Promise res = worker->GetPromise();
+  if (m_Busy) {
+    m_PendingWork.push_back(worker);
+  } else {
+    m_Busy = true;
+    worker->Queue();
+  }
+  return res;
+}
+
+void Loot::workFinished() {
+  if (m_PendingWork.empty()) {
+    m_Busy = false;
+  } else {
+    Napi::AsyncWorker *next = m_PendingWork.front();
+    m_PendingWork.pop_front();
+    next->Queue();
+  }
+}
+
+LogQueue::Scope Loot::checkIdle(const Napi::Env &env) const {
+  if (m_Busy) {
+    throw BusyException(env);
+  }
+  return LogQueue::Scope(m_LogQueue);
+}
+
+Napi::Value Loot::getMetadataCacheStats(const Napi::CallbackInfo &info) {
+  // only reads counters so this is fine while asynchronous work is running
+  return toNAPI(info.Env(), m_MetadataCache.stats());
+}
+
+Napi::Value Loot::setLogLevel(const Napi::CallbackInfo &info) {
+  int level;
+  unpackArgs(info, level);
+
+  m_LogQueue->setLevel(level);
+  return info.Env().Undefined();
+}
+
+Napi::Value Loot::loadListsAsync(const Napi::CallbackInfo &info) {
+  std::wstring masterlistPath, userlistPath, preludePath;
+  unpackArgs(info, masterlistPath, userlistPath, preludePath);
+
+  return queueWork<ListsLoadResult>(info, "loadLists", [this, masterlistPath, userlistPath, preludePath]() {
+    return loadListsImpl(masterlistPath, userlistPath, preludePath);
+  });
+}
+
+Napi::Value Loot::loadPluginsAsync(const Napi::CallbackInfo &info) {
+  std::vector<std::string> plugins;
+  bool headersOnly, incremental = false;
+  unpackArgs<2>(info, plugins, headersOnly, incremental);
+
+  if (incremental) {
+    return queueWork<IncrementalLoadResult>(info, "loadPlugins", [this, plugins, headersOnly]() {
+      return loadPluginsIncremental(plugins, headersOnly);
+    });
+  }
+
+  std::vector<std::filesystem::path> pluginPaths;
+  std::transform(plugins.begin(), plugins.end(), std::back_inserter(pluginPaths), [](const std::string& str) {
+    return std::filesystem::path(str);
+  });
+
+  return queueWork<std::monostate>(info, "loadPlugins", [this, pluginPaths, headersOnly]() {
+    m_PluginFingerprints->clear();
+    m_MetadataCache.invalidateConditional();
+    m_Game->LoadPlugins(pluginPaths, headersOnly);
+    return std::monostate();
+  });
+}
+
+Napi::Value Loot::loadCurrentLoadOrderStateAsync(const Napi::CallbackInfo &info) {
+  return queueWork<std::monostate>(info, "loadCurrentLoadOrderState", [this]() {
+    m_MetadataCache.invalidateConditional();
+    m_Game->LoadCurrentLoadOrderState();
+    return std::monostate();
+  });
+}
+
+Napi::Value Loot::getPluginAsync(const Napi::CallbackInfo &info) {
+  std::string pluginName;
+  unpackArgs(info, pluginName);
+
+  return queueWork<std::unique_ptr<const loot::PluginInterface>>(info, "getPlugin", [this, pluginName]() {
+    return m_Game->GetPlugin(pluginName);
+  });
+}
+
+Napi::Value Loot::getPluginsSnapshotAsync(const Napi::CallbackInfo &info) {
+  return queueWork<PluginsSnapshot>(info, "getPluginsSnapshot", [this]() {
+    return createPluginsSnapshot(*m_Game);
+  });
+}
+
+Napi::Value Loot::getPluginMetadataAsync(const Napi::CallbackInfo &info) {
+  std::string pluginName;
+  bool includeUserMetadata = true, evaluateConditions = true, lazy = false;
+  unpackArgs<1>(info, pluginName, includeUserMetadata, evaluateConditions, lazy);
+
+  if (lazy) {
+    return queueWork<LazyPluginMetadata>(info, "getPluginMetadata",
+      [this, pluginName, includeUserMetadata, evaluateConditions]() {
+        return LazyPluginMetadata{ getMetadataImpl(pluginName, includeUserMetadata, evaluateConditions) };
+      });
+  }
+
+  return queueWork<std::optional<loot::PluginMetadata>>(info, "getPluginMetadata",
+    [this, pluginName, includeUserMetadata, evaluateConditions]() {
+      return getMetadataImpl(pluginName, includeUserMetadata, evaluateConditions);
+    });
+}
+
+Napi::Value Loot::getPluginsMetadataAsync(const Napi::CallbackInfo &info) {
+  std::vector<std::string> pluginNames;
+  bool includeUserMetadata = true, evaluateConditions = true;
+  unpackArgs<1>(info, pluginNames, includeUserMetadata, evaluateConditions);
+
+  return queueWork<std::vector<std::optional<loot::PluginMetadata>>>(info, "getPluginsMetadata",
+    [this, pluginNames, includeUserMetadata, evaluateConditions]() {
+      return getMetadataListImpl(pluginNames, includeUserMetadata, evaluateConditions);
+    });
+}
+
+Napi::Value Loot::getLoadOrderAsync(const Napi::CallbackInfo &info) {
+  return queueWork<std::vector<std::string>>(info, "getLoadOrder", [this]() {
+    return m_Game->GetLoadOrder();
+  });
+}
+
+Napi::Value Loot::getGroupsAsync(const Napi::CallbackInfo &info) {
+  bool includeUserGroups;
+  unpackArgs(info, includeUserGroups);
+
+  return queueWork<std::vector<loot::Group>>(info, "getGroups", [this, includeUserGroups]() {
+    return m_Game->GetDatabase().GetGroups(includeUserGroups);
+  });
+}
+
+Napi::Value Loot::getUserGroupsAsync(const Napi::CallbackInfo &info) {
+  return queueWork<std::vector<loot::Group>>(info, "getUserGroups", [this]() {
+    return m_Game->GetDatabase().GetUserGroups();
+  });
+}
+
+Napi::Value Loot::getGroupsPathAsync(const Napi::CallbackInfo &info) {
+  std::string fromGroupName, toGroupName;
+  unpackArgs(info, fromGroupName, toGroupName);
+
+  return queueWork<std::vector<loot::Vertex>>(info, "getGroupsPath", [this, fromGroupName, toGroupName]() {
+    return m_Game->GetDatabase().GetGroupsPath(fromGroupName, toGroupName);
+  });
+}
+
+Napi::Value Loot::getGeneralMessagesAsync(const Napi::CallbackInfo &info) {
+  bool evaluateConditions;
+  unpackArgs(info, evaluateConditions);
+
+  return queueWork<std::vector<loot::Message>>(info, "getGeneralMessages", [this, evaluateConditions]() {
+    return m_Game->GetDatabase().GetGeneralMessages(true, evaluateConditions);
+  });
+}
+
+Napi::Value Loot::isPluginActiveAsync(const Napi::CallbackInfo &info) {
+  std::string pluginName;
+  unpackArgs(info, pluginName);
+
+  return queueWork<bool>(info, "isPluginActive", [this, pluginName]() {
+    return m_Game->IsPluginActive(pluginName);
+  });
+}
+
+Napi::Value Loot::setLoadOrderAsync(const Napi::CallbackInfo &info) {
+  std::vector<std::string> plugins;
+  unpackArgs(info, plugins);
+
+  return queueWork<std::monostate>(info, "setLoadOrder", [this, plugins]() {
+    m_MetadataCache.invalidateConditional();
+    m_Game->SetLoadOrder(plugins);
+    return std::monostate();
+  });
+}
+
+Napi::Value Loot::setUserGroupsAsync(const Napi::CallbackInfo &info) {
+  std::vector<loot::Group> groups;
+  unpackArgs(info, groups);
+
+  return queueWork<std::monostate>(info, "setUserGroups", [this, groups]() {
+    m_LoadedLists.userlistModified();
+    m_MetadataCache.invalidate();
+    m_Game->GetDatabase().SetUserGroups(groups);
+    return std::monostate();
+  });
+}
+
+Napi::Value Loot::sortPluginsAsync(const Napi::CallbackInfo &info) {
+  std::vector<std::string> plugins;
+  unpackArgs(info, plugins);
+
+  return queueWork<std::vector<std::string>>(info, "sortPlugins", [this, plugins]() {
+    return sortPluginsImpl(plugins);
+  });
+}
+
+Napi::Value Loot::clearConditionCacheAsync(const Napi::CallbackInfo &info) {
+  return queueWork<std::monostate>(info, "clearConditionCache", [this]() {
+    m_MetadataCache.invalidateConditional();
+    m_Game->GetDatabase().ClearConditionCache();
+    m_SortCache.clear();
+    return std::monostate();
+  });
+}
+
+Napi::Value Loot::invalidateConditionsForPathsAsync(const Napi::CallbackInfo &info) {
+  std::vector<std::string> paths;
+  unpackArgs(info, paths);
+
+  return queueWork<uint32_t>(info, "invalidateConditionsForPaths", [this, paths]() {
+    return invalidateConditionsImpl(paths);
+  });
+}
+
+Napi::Value Loot::getPluginMetadataEncodedAsync(const Napi::CallbackInfo &info) {
+  std::string pluginName;
+  bool includeUserMetadata = true, evaluateConditions = true;
+  unpackArgs<1>(info, pluginName, includeUserMetadata, evaluateConditions);
+
+  return queueWork<EncodedJSON>(info, "getPluginMetadata",
+    [this, pluginName, includeUserMetadata, evaluateConditions]() {
+      auto meta = getMetadataImpl(pluginName, includeUserMetadata, evaluateConditions);
+      // no metadata is an undefined result which JSON.stringify would leave out entirely
+      return meta.has_value() ? encodeJSON(*meta) : EncodedJSON();
+    });
+}
+
+Napi::Value Loot::getPluginsMetadataEncodedAsync(const Napi::CallbackInfo &info) {
+  std::vector<std::string> pluginNames;
+  bool includeUserMetadata = true, evaluateConditions = true;
+  unpackArgs<1>(info, pluginNames, includeUserMetadata, evaluateConditions);
+
+  return queueWork<EncodedJSON>(info, "getPluginsMetadata",
+    [this, pluginNames, includeUserMetadata, evaluateConditions]() {
+      return encodeJSON(getMetadataListImpl(pluginNames, includeUserMetadata, evaluateConditions));
+    });
+}
+
+Napi::Value Loot::getLoadOrderEncodedAsync(const Napi::CallbackInfo &info) {
+  return queueWork<EncodedJSON>(info, "getLoadOrder", [this]() {
+    return encodeJSON(m_Game->GetLoadOrder());
+  });
+}
+
+Napi::Value Loot::getGroupsEncodedAsync(const Napi::CallbackInfo &info) {
+  bool includeUserGroups;
+  unpackArgs(info, includeUserGroups);
+
+  return queueWork<EncodedJSON>(info, "getGroups", [this, includeUserGroups]() {
+    return encodeJSON(m_Game->GetDatabase().GetGroups(includeUserGroups));
+  });
+}
+
+Napi::Value Loot::getUserGroupsEncodedAsync(const Napi::CallbackInfo &info) {
+  return queueWork<EncodedJSON>(info, "getUserGroups", [this]() {
+    return encodeJSON(m_Game->GetDatabase().GetUserGroups());
+  });
+}
+
+Napi::Value Loot::getGroupsPathEncodedAsync(const Napi::CallbackInfo &info) {
+  std::string fromGroupName, toGroupName;
+  unpackArgs(info, fromGroupName, toGroupName);
+
+  return queueWork<EncodedJSON>(info, "getGroupsPath", [this, fromGroupName, toGroupName]() {
+    return encodeJSON(m_Game->GetDatabase().GetGroupsPath(fromGroupName, toGroupName));
+  });
+}
+
+Napi::Value Loot::sortPluginsEncodedAsync(const Napi::CallbackInfo &info) {
+  std::vector<std::string> plugins;
+  unpackArgs(info, plugins);
+
+  return queueWork<EncodedJSON>(info, "sortPlugins", [this, plugins]() {
+    return encodeJSON(sortPluginsImpl(plugins));
+  });
+}
+
 Napi::Value SetErrorLanguageEN(const Napi::CallbackInfo &info) {
 #ifdef WIN32
   ULONG count = 1;
@@ -434,10 +996,31 @@ Napi::Boolean IsCompatible(const Napi::CallbackInfo &info) {
   return Napi::Boolean::New(info.Env(), loot::IsCompatible(major, minor, patch));
 }
 
+Napi::Object PluginFlags(Napi::Env env) {
+  Napi::Object res = Napi::Object::New(env);
+  res.Set("isMaster", static_cast<uint32_t>(PLUGIN_MASTER));
+  res.Set("isLightPlugin", static_cast<uint32_t>(PLUGIN_LIGHT));
+  res.Set("IsMediumPlugin", static_cast<uint32_t>(PLUGIN_MEDIUM));
+  res.Set("IsUpdatePlugin", static_cast<uint32_t>(PLUGIN_UPDATE));
+  res.Set("IsBlueprintPlugin", static_cast<uint32_t>(PLUGIN_BLUEPRINT));
+  res.Set("isEmpty", static_cast<uint32_t>(PLUGIN_EMPTY));
+  res.Set("loadsArchive", static_cast<uint32_t>(PLUGIN_LOADS_ARCHIVE));
+  res.Set("isValidAsLightPlugin", static_cast<uint32_t>(PLUGIN_VALID_AS_LIGHT));
+  res.Set("IsValidAsMediumPlugin", static_cast<uint32_t>(PLUGIN_VALID_AS_MEDIUM));
+  res.Set("IsValidAsUpdatePlugin", static_cast<uint32_t>(PLUGIN_VALID_AS_UPDATE));
+  res.Set("isActive", static_cast<uint32_t>(PLUGIN_ACTIVE));
+  res.Set("hasCRC", static_cast<uint32_t>(PLUGIN_HAS_CRC));
+  return res;
+}
+
 Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
+  env.SetInstanceData(new AddonData(env));
+  exports.Set("PluginFlags", PluginFlags(env));
   exports.Set("SetErrorLanguageEN", Napi::Function::New(env, SetErrorLanguageEN));
   exports.Set("SetLogLevel", Napi::Function::New(env, SetLogLevel));
   exports.Set("IsCompatible", Napi::Function::New(env, IsCompatible));
+  PluginMetadataHandle::Init(env, exports);
+  SharedRegion::Init(env, exports);
   Loot::Init(env, exports);
   return exports;
 }
@@ -1,15 +1,24 @@
 #pragma once
 
 #include <loot/api.h>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
 #include <set>
 #include <unordered_set>
 #include <napi.h>
+#include "loaded_lists.h"
+#include "log_queue.h"
+#include "metadata_cache.h"
+#include "sort_cache.h"
 
 typedef std::function<void(int level, const char *message)> LogFunc;
 
+template<typename ResultT> class LootWorker;
+class PluginFingerprints;
+struct IncrementalLoadResult;
+
 class Loot : public Napi::ObjectWrap<Loot> {
 
 public:
@@ -20,7 +29,9 @@ public:
       InstanceMethod("loadPlugins", &Loot::loadPlugins),
       InstanceMethod("loadCurrentLoadOrderState", &Loot::loadCurrentLoadOrderState),
       InstanceMethod("getPlugin", &Loot::getPlugin),
+      InstanceMethod("getPluginsSnapshot", &Loot::getPluginsSnapshot),
       InstanceMethod("getPluginMetadata", &Loot::getPluginMetadata),
+      InstanceMethod("getPluginsMetadata", &Loot::getPluginsMetadata),
       InstanceMethod("getLoadOrder", &Loot::getLoadOrder),
       InstanceMethod("getGroups", &Loot::getGroups),
       InstanceMethod("getUserGroups", &Loot::getUserGroups),
@@ -30,7 +41,36 @@ public:
       InstanceMethod("setLoadOrder", &Loot::setLoadOrder),
       InstanceMethod("setUserGroups", &Loot::setUserGroups),
       InstanceMethod("sortPlugins", &Loot::sortPlugins),
-      InstanceMethod("clearConditionCache", &Loot::clearConditionCache)
+      InstanceMethod("setSortCache", &Loot::setSortCache),
+      InstanceMethod("clearConditionCache", &Loot::clearConditionCache),
+      InstanceMethod("invalidateConditionsForPaths", &Loot::invalidateConditionsForPaths),
+      InstanceMethod("setLogLevel", &Loot::setLogLevel),
+      InstanceMethod("getMetadataCacheStats", &Loot::getMetadataCacheStats),
+      InstanceMethod("loadListsAsync", &Loot::loadListsAsync),
+      InstanceMethod("loadPluginsAsync", &Loot::loadPluginsAsync),
+      InstanceMethod("loadCurrentLoadOrderStateAsync", &Loot::loadCurrentLoadOrderStateAsync),
+      InstanceMethod("getPluginAsync", &Loot::getPluginAsync),
+      InstanceMethod("getPluginsSnapshotAsync", &Loot::getPluginsSnapshotAsync),
+      InstanceMethod("getPluginMetadataAsync", &Loot::getPluginMetadataAsync),
+      InstanceMethod("getPluginsMetadataAsync", &Loot::getPluginsMetadataAsync),
+      InstanceMethod("getLoadOrderAsync", &Loot::getLoadOrderAsync),
+      InstanceMethod("getGroupsAsync", &Loot::getGroupsAsync),
+      InstanceMethod("getUserGroupsAsync", &Loot::getUserGroupsAsync),
+      InstanceMethod("getGroupsPathAsync", &Loot::getGroupsPathAsync),
+      InstanceMethod("getGeneralMessagesAsync", &Loot::getGeneralMessagesAsync),
+      InstanceMethod("isPluginActiveAsync", &Loot::isPluginActiveAsync),
+      InstanceMethod("setLoadOrderAsync", &Loot::setLoadOrderAsync),
+      InstanceMethod("setUserGroupsAsync", &Loot::setUserGroupsAsync),
+      InstanceMethod("sortPluginsAsync", &Loot::sortPluginsAsync),
+      InstanceMethod("clearConditionCacheAsync", &Loot::clearConditionCacheAsync),
+      InstanceMethod("invalidateConditionsForPathsAsync", &Loot::invalidateConditionsForPathsAsync),
+      InstanceMethod("getPluginMetadataEncodedAsync", &Loot::getPluginMetadataEncodedAsync),
+      InstanceMethod("getPluginsMetadataEncodedAsync", &Loot::getPluginsMetadataEncodedAsync),
+      InstanceMethod("getLoadOrderEncodedAsync", &Loot::getLoadOrderEncodedAsync),
+      InstanceMethod("getGroupsEncodedAsync", &Loot::getGroupsEncodedAsync),
+      InstanceMethod("getUserGroupsEncodedAsync", &Loot::getUserGroupsEncodedAsync),
+      InstanceMethod("getGroupsPathEncodedAsync", &Loot::getGroupsPathEncodedAsync),
+      InstanceMethod("sortPluginsEncodedAsync", &Loot::sortPluginsEncodedAsync)
       });
     exports.Set("Loot", func);
     return exports;
@@ -38,16 +78,26 @@ public:
 
   Loot(const Napi::CallbackInfo &info);
 
+  ~Loot();
+
+  // lists whose content didn't change since they were last loaded are skipped. Returns for each list
+  // whether it was reloaded and its content hash
   Napi::Value loadLists(const Napi::CallbackInfo &info);
 
+  // with the optional third parameter set, only plugins that aren't loaded yet or changed on disk since
+  // they were loaded (size, modification time) are parsed. Resolves to what was loaded then
   Napi::Value loadPlugins(const Napi::CallbackInfo &info);
 
   Napi::Value loadCurrentLoadOrderState(const Napi::CallbackInfo &info);
 
   Napi::Value getPlugin(const Napi::CallbackInfo &info);
 
+  Napi::Value getPluginsSnapshot(const Napi::CallbackInfo &info);
+
   Napi::Value getPluginMetadata(const Napi::CallbackInfo &info);
 
+  Napi::Value getPluginsMetadata(const Napi::CallbackInfo &info);
+
   Napi::Value getLoadOrder(const Napi::CallbackInfo &info);
 
   Napi::Value getGroups(const Napi::CallbackInfo &info);
@@ -66,13 +116,133 @@ public:
 
   Napi::Value sortPlugins(const Napi::CallbackInfo &info);
 
+  // directory to keep sort results in so sorting the same plugins in the same state again is
+  // answered from there, empty to disable
+  Napi::Value setSortCache(const Napi::CallbackInfo &info);
+
   Napi::Value clearConditionCache(const Napi::CallbackInfo &info);
 
+  // files changed. Only cached metadata whose conditions refer to one of these is dropped, libloot's
+  // condition cache is cleared entirely. Returns the number of metadata results dropped
+  Napi::Value invalidateConditionsForPaths(const Napi::CallbackInfo &info);
+
+  // messages below this level are discarded before they are passed to the log callback
+  Napi::Value setLogLevel(const Napi::CallbackInfo &info);
+
+  // hits and misses of the plugin metadata cache and the number of results it holds
+  Napi::Value getMetadataCacheStats(const Napi::CallbackInfo &info);
+
+  // promise-returning variants of the above. The libloot call is made on the libuv threadpool,
+  // only the conversion of the result happens on the main thread
+
+  Napi::Value loadListsAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value loadPluginsAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value loadCurrentLoadOrderStateAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value getPluginAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value getPluginsSnapshotAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value getPluginMetadataAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value getPluginsMetadataAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value getLoadOrderAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value getGroupsAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value getUserGroupsAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value getGroupsPathAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value getGeneralMessagesAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value isPluginActiveAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value setLoadOrderAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value setUserGroupsAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value sortPluginsAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value clearConditionCacheAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value invalidateConditionsForPathsAsync(const Napi::CallbackInfo &info);
+
+  // variants of the above resolving to a Buffer with the result encoded as json (what JSON.stringify would
+  // produce for the regular result). These are meant for passing results on to another process, no
+  // javascript objects are created
+
+  Napi::Value getPluginMetadataEncodedAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value getPluginsMetadataEncodedAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value getLoadOrderEncodedAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value getGroupsEncodedAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value getUserGroupsEncodedAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value getGroupsPathEncodedAsync(const Napi::CallbackInfo &info);
+
+  Napi::Value sortPluginsEncodedAsync(const Napi::CallbackInfo &info);
+
+private:
+
+  template<typename ResultT> friend class LootWorker;
+
+  template<typename ResultT>
+  Napi::Value queueWork(const Napi::CallbackInfo &info, const char *func, std::function<ResultT()> work);
+
+  void workFinished();
+
+  ListsLoadResult loadListsImpl(const std::wstring &masterlistPath, const std::wstring &userlistPath,
+                                const std::wstring &preludePath);
+
+  // incremental load, dropping cached metadata if plugins were parsed
+  IncrementalLoadResult loadPluginsIncremental(const std::vector<std::string> &plugins, bool headersOnly);
+
+  // metadata lookups answered from the metadata cache where possible
+  std::optional<loot::PluginMetadata> getMetadataImpl(const std::string &pluginName, bool includeUserMetadata,
+                                                      bool evaluateConditions);
+  std::vector<std::optional<loot::PluginMetadata>> getMetadataListImpl(const std::vector<std::string> &pluginNames,
+                                                                       bool includeUserMetadata,
+                                                                       bool evaluateConditions);
+
+  // the metadata without evaluated conditions, from the cache or looked up and stored there
+  const std::optional<loot::PluginMetadata> &rawMetadata(const std::string &pluginName, bool includeUserMetadata);
+
+  // paths (absolute or relative to the data directory) in the form conditions use
+  std::vector<std::string> toConditionPaths(const std::vector<std::string> &paths) const;
+
+  uint32_t invalidateConditionsImpl(const std::vector<std::string> &paths);
+
+  // sort, using the sort cache if it's enabled
+  std::vector<std::string> sortPluginsImpl(const std::vector<std::string> &plugins);
+
+  // the game handle isn't thread safe so synchronous calls are refused while asynchronous work is pending.
+  // libloot messages logged on this thread are attributed to this instance while the result exists
+  [[nodiscard]] LogQueue::Scope checkIdle(const Napi::Env &env) const;
+
+  static void closeLogQueue(void *queue);
+
+  void stopLogging(napi_env env);
+
 private:
 
   std::string m_Language;
   std::unique_ptr<loot::GameInterface> m_Game;
-  Napi::ThreadSafeFunction m_LogCallback;
+  std::unique_ptr<PluginFingerprints> m_PluginFingerprints;
+  LoadedLists m_LoadedLists;
+  SortCache m_SortCache;
+  MetadataCache m_MetadataCache;
+  std::shared_ptr<LogQueue> m_LogQueue;
+
+  // asynchronous calls are run one at a time, in the order they were made
+  bool m_Busy{ false };
+  std::deque<Napi::AsyncWorker*> m_PendingWork;
 
 };
 
@@ -0,0 +1,78 @@
+#include "metadata_cache.h"
+#include <algorithm>
+#include <cctype>
+
+static const char FLAG_USER_METADATA = 1;
+static const char FLAG_EVALUATE_CONDITIONS = 2;
+
+// libloot compares plugin names case-insensitively
+std::string MetadataCache::key(const std::string &plugin, bool includeUserMetadata, bool evaluateConditions) {
+  std::string res(1, static_cast<char>((includeUserMetadata ? FLAG_USER_METADATA : 0)
+                                     | (evaluateConditions ? FLAG_EVALUATE_CONDITIONS : 0)));
+  res.reserve(plugin.size() + 1);
+  std::transform(plugin.begin(), plugin.end(), std::back_inserter(res),
+                 [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+  return res;
+}
+
+const std::optional<loot::PluginMetadata> *MetadataCache::find(const std::string &plugin, bool includeUserMetadata,
+                                                               bool evaluateConditions) {
+  auto iter = m_Entries.find(key(plugin, includeUserMetadata, evaluateConditions));
+  if (iter == m_Entries.end()) {
+    ++m_Misses;
+    return nullptr;
+  }
+  ++m_Hits;
+  return &iter->second.metadata;
+}
+
+const std::optional<loot::PluginMetadata> *MetadataCache::peek(const std::string &plugin, bool includeUserMetadata,
+                                                               bool evaluateConditions) const {
+  auto iter = m_Entries.find(key(plugin, includeUserMetadata, evaluateConditions));
+  return iter != m_Entries.end() ? &iter->second.metadata : nullptr;
+}
+
+void MetadataCache::store(const std::string &plugin, bool includeUserMetadata, bool evaluateConditions,
+                          const std::optional<loot::PluginMetadata> &metadata, ConditionPaths dependencies) {
+  m_Entries.insert_or_assign(key(plugin, includeUserMetadata, evaluateConditions),
+                             Entry{ metadata, std::move(dependencies) });
+  updateEntryCount();
+}
+
+void MetadataCache::invalidate() {
+  m_Entries.clear();
+  updateEntryCount();
+}
+
+void MetadataCache::invalidateConditional() {
+  for (auto iter = m_Entries.begin(); iter != m_Entries.end();) {
+    if ((iter->first[0] & FLAG_EVALUATE_CONDITIONS) != 0) {
+      iter = m_Entries.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  updateEntryCount();
+}
+
+size_t MetadataCache::invalidateForPaths(const std::vector<std::string> &paths) {
+  size_t res = 0;
+  for (auto iter = m_Entries.begin(); iter != m_Entries.end();) {
+    if (((iter->first[0] & FLAG_EVALUATE_CONDITIONS) != 0) && iter->second.dependencies.matches(paths)) {
+      iter = m_Entries.erase(iter);
+      ++res;
+    } else {
+      ++iter;
+    }
+  }
+  updateEntryCount();
+  return res;
+}
+
+MetadataCacheStats MetadataCache::stats() const {
+  MetadataCacheStats res;
+  res.hits = m_Hits;
+  res.misses = m_Misses;
+  res.entries = m_EntryCount;
+  return res;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <loot/api.h>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "condition_paths.h"
+
+struct MetadataCacheStats {
+  uint64_t hits{ 0 };
+  uint64_t misses{ 0 };
+  uint64_t entries{ 0 };
+};
+
+/**
+ * results of GetPluginMetadata by plugin and parameters, so repeated lookups don't have to merge the
+ * masterlist and userlist entries and evaluate their conditions again.
+ * Not thread safe except for stats, lookups on several threads have to be done outside the cache
+ */
+class MetadataCache {
+public:
+
+  // nullptr if there is no cached result. Valid until the cache is modified
+  const std::optional<loot::PluginMetadata> *find(const std::string &plugin, bool includeUserMetadata,
+                                                  bool evaluateConditions);
+
+  // like find but not counted in the stats, for lookups the caller didn't ask for
+  const std::optional<loot::PluginMetadata> *peek(const std::string &plugin, bool includeUserMetadata,
+                                                  bool evaluateConditions) const;
+
+  // dependencies are the files the conditions evaluated for the result refer to
+  void store(const std::string &plugin, bool includeUserMetadata, bool evaluateConditions,
+             const std::optional<loot::PluginMetadata> &metadata, ConditionPaths dependencies = ConditionPaths());
+
+  // the lists changed, nothing cached is valid anymore
+  void invalidate();
+
+  // conditions may evaluate differently now (plugins or load order changed, condition cache cleared).
+  // Results looked up without evaluating conditions are kept
+  void invalidateConditional();
+
+  // drop the results with evaluated conditions that refer to any of the (normalized) paths. Returns the
+  // number of results dropped
+  size_t invalidateForPaths(const std::vector<std::string> &paths);
+
+  MetadataCacheStats stats() const;
+
+private:
+
+  static std::string key(const std::string &plugin, bool includeUserMetadata, bool evaluateConditions);
+
+  void updateEntryCount() {
+    m_EntryCount = m_Entries.size();
+  }
+
+private:
+
+  struct Entry {
+    std::optional<loot::PluginMetadata> metadata;
+    ConditionPaths dependencies;
+  };
+
+  std::unordered_map<std::string, Entry> m_Entries;
+
+  // may be read while a lookup is running on a worker thread
+  std::atomic<uint64_t> m_Hits{ 0 };
+  std::atomic<uint64_t> m_Misses{ 0 };
+  std::atomic<uint64_t> m_EntryCount{ 0 };
+
+};
@@ -0,0 +1,133 @@
+#include "metadata_handle.h"
+#include "addon_data.h"
+#include "converters.h"
+#include "property_keys.h"
+
+void PluginMetadataHandle::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(env, "PluginMetadataHandle", {
+    InstanceAccessor<&PluginMetadataHandle::getCleanInfo>("cleanInfo", napi_enumerable),
+    InstanceAccessor<&PluginMetadataHandle::getDirtyInfo>("dirtyInfo", napi_enumerable),
+    InstanceAccessor<&PluginMetadataHandle::getGroup>("group", napi_enumerable),
+    InstanceAccessor<&PluginMetadataHandle::getIncompatibilities>("incompatibilities", napi_enumerable),
+    InstanceAccessor<&PluginMetadataHandle::getLoadAfterFiles>("loadAfterFiles", napi_enumerable),
+    InstanceAccessor<&PluginMetadataHandle::getLocations>("locations", napi_enumerable),
+    InstanceAccessor<&PluginMetadataHandle::getMessages>("messages", napi_enumerable),
+    InstanceAccessor<&PluginMetadataHandle::getName>("name", napi_enumerable),
+    InstanceAccessor<&PluginMetadataHandle::getRequirements>("requirements", napi_enumerable),
+    InstanceAccessor<&PluginMetadataHandle::getTags>("tags", napi_enumerable),
+    InstanceMethod("toJSON", &PluginMetadataHandle::toJSON),
+    });
+  env.GetInstanceData<AddonData>()->metadataHandleConstructor = Napi::Persistent(func);
+  exports.Set("PluginMetadataHandle", func);
+}
+
+Napi::Object PluginMetadataHandle::Create(const Napi::Env &env, loot::PluginMetadata metadata) {
+  Napi::Object res = env.GetInstanceData<AddonData>()->metadataHandleConstructor.New({});
+  Unwrap(res)->m_Metadata = std::move(metadata);
+  return res;
+}
+
+PluginMetadataHandle::PluginMetadataHandle(const Napi::CallbackInfo &info)
+  : Napi::ObjectWrap<PluginMetadataHandle>(info)
+{
+}
+
+template<typename GetterT>
+Napi::Value PluginMetadataHandle::cached(const Napi::Env &env, Field field, GetterT getter) {
+  if (!m_Metadata.has_value()) {
+    return env.Undefined();
+  }
+
+  Napi::Reference<Napi::Value> &ref = m_Converted[field];
+  if (ref.IsEmpty()) {
+    ref = Napi::Persistent(getter(*m_Metadata));
+  }
+  return ref.Value();
+}
+
+Napi::Value PluginMetadataHandle::getCleanInfo(const Napi::CallbackInfo &info) {
+  return cached(info.Env(), CLEAN_INFO, [&](const loot::PluginMetadata &meta) {
+    return toNAPI(info.Env(), meta.GetCleanInfo());
+  });
+}
+
+Napi::Value PluginMetadataHandle::getDirtyInfo(const Napi::CallbackInfo &info) {
+  return cached(info.Env(), DIRTY_INFO, [&](const loot::PluginMetadata &meta) {
+    return toNAPI(info.Env(), meta.GetDirtyInfo());
+  });
+}
+
+Napi::Value PluginMetadataHandle::getGroup(const Napi::CallbackInfo &info) {
+  return cached(info.Env(), GROUP, [&](const loot::PluginMetadata &meta) {
+    return Napi::Value::From(info.Env(), meta.GetGroup().value_or(""));
+  });
+}
+
+Napi::Value PluginMetadataHandle::getIncompatibilities(const Napi::CallbackInfo &info) {
+  return cached(info.Env(), INCOMPATIBILITIES, [&](const loot::PluginMetadata &meta) {
+    return toNAPI(info.Env(), meta.GetIncompatibilities());
+  });
+}
+
+Napi::Value PluginMetadataHandle::getLoadAfterFiles(const Napi::CallbackInfo &info) {
+  return cached(info.Env(), LOAD_AFTER_FILES, [&](const loot::PluginMetadata &meta) {
+    return toNAPI(info.Env(), meta.GetLoadAfterFiles());
+  });
+}
+
+Napi::Value PluginMetadataHandle::getLocations(const Napi::CallbackInfo &info) {
+  return cached(info.Env(), LOCATIONS, [&](const loot::PluginMetadata &meta) {
+    return toNAPI(info.Env(), meta.GetLocations());
+  });
+}
+
+Napi::Value PluginMetadataHandle::getMessages(const Napi::CallbackInfo &info) {
+  return cached(info.Env(), MESSAGES, [&](const loot::PluginMetadata &meta) {
+    return toNAPI(info.Env(), meta.GetMessages());
+  });
+}
+
+Napi::Value PluginMetadataHandle::getName(const Napi::CallbackInfo &info) {
+  return cached(info.Env(), NAME, [&](const loot::PluginMetadata &meta) {
+    return Napi::Value::From(info.Env(), meta.GetName());
+  });
+}
+
+Napi::Value PluginMetadataHandle::getRequirements(const Napi::CallbackInfo &info) {
+  return cached(info.Env(), REQUIREMENTS, [&](const loot::PluginMetadata &meta) {
+    return toNAPI(info.Env(), meta.GetRequirements());
+  });
+}
+
+Napi::Value PluginMetadataHandle::getTags(const Napi::CallbackInfo &info) {
+  return cached(info.Env(), TAGS, [&](const loot::PluginMetadata &meta) {
+    return toNAPI(info.Env(), meta.GetTags());
+  });
+}
+
+Napi::Value PluginMetadataHandle::toJSON(const Napi::CallbackInfo &info) {
+  if (!m_Metadata.has_value()) {
+    return info.Env().Undefined();
+  }
+
+  return makeObject(info.Env(), {
+    { Key::cleanInfo, getCleanInfo(info) },
+    { Key::dirtyInfo, getDirtyInfo(info) },
+    { Key::group, getGroup(info) },
+    { Key::incompatibilities, getIncompatibilities(info) },
+    { Key::loadAfterFiles, getLoadAfterFiles(info) },
+    { Key::locations, getLocations(info) },
+    { Key::messages, getMessages(info) },
+    { Key::name, getName(info) },
+    { Key::requirements, getRequirements(info) },
+    { Key::tags, getTags(info) },
+  });
+}
+
+template<>
+Napi::Value toNAPI<LazyPluginMetadata>(const Napi::Env &env, const LazyPluginMetadata &input) {
+  if (!input.metadata.has_value()) {
+    return env.Undefined();
+  }
+  return PluginMetadataHandle::Create(env, *input.metadata);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <loot/api.h>
+#include <array>
+#include <optional>
+#include <napi.h>
+#include "napi_helpers.h"
+
+/**
+ * javascript object wrapping a loot::PluginMetadata. Each field is only converted to javascript
+ * values when it's first accessed, the converted value is then kept for subsequent accesses
+ */
+class PluginMetadataHandle : public Napi::ObjectWrap<PluginMetadataHandle> {
+
+public:
+
+  static void Init(Napi::Env env, Napi::Object exports);
+
+  static Napi::Object Create(const Napi::Env &env, loot::PluginMetadata metadata);
+
+  PluginMetadataHandle(const Napi::CallbackInfo &info);
+
+  Napi::Value getCleanInfo(const Napi::CallbackInfo &info);
+
+  Napi::Value getDirtyInfo(const Napi::CallbackInfo &info);
+
+  Napi::Value getGroup(const Napi::CallbackInfo &info);
+
+  Napi::Value getIncompatibilities(const Napi::CallbackInfo &info);
+
+  Napi::Value getLoadAfterFiles(const Napi::CallbackInfo &info);
+
+  Napi::Value getLocations(const Napi::CallbackInfo &info);
+
+  Napi::Value getMessages(const Napi::CallbackInfo &info);
+
+  Napi::Value getName(const Napi::CallbackInfo &info);
+
+  Napi::Value getRequirements(const Napi::CallbackInfo &info);
+
+  Napi::Value getTags(const Napi::CallbackInfo &info);
+
+  // converts all fields, producing the same object getPluginMetadata returns in non-lazy mode
+  Napi::Value toJSON(const Napi::CallbackInfo &info);
+
+private:
+
+  enum Field {
+    CLEAN_INFO,
+    DIRTY_INFO,
+    GROUP,
+    INCOMPATIBILITIES,
+    LOAD_AFTER_FILES,
+    LOCATIONS,
+    MESSAGES,
+    NAME,
+    REQUIREMENTS,
+    TAGS,
+    FIELD_COUNT
+  };
+
+  template<typename GetterT>
+  Napi::Value cached(const Napi::Env &env, Field field, GetterT getter);
+
+private:
+
+  std::optional<loot::PluginMetadata> m_Metadata;
+  std::array<Napi::Reference<Napi::Value>, FIELD_COUNT> m_Converted;
+
+};
+
+/**
+ * result of a metadata lookup that is to be returned as a PluginMetadataHandle
+ */
+struct LazyPluginMetadata {
+  std::optional<loot::PluginMetadata> metadata;
+};
+
+template<> Napi::Value toNAPI<LazyPluginMetadata>(const Napi::Env &env, const LazyPluginMetadata &input);
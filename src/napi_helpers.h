@@ -1,4 +1,9 @@
+#pragma once
+
 #include <napi.h>
+#include <algorithm>
+#include <memory>
+#include <optional>
 #include "string_cast.h"
 
 template<typename T>
@@ -17,6 +22,23 @@ Napi::Value toNAPI(const Napi::Env &env, const std::vector<T> &input) {
   return result;
 }
 
+template<typename T>
+Napi::Value toNAPI(const Napi::Env &env, const std::optional<T> &input) {
+  return input.has_value() ? toNAPI(env, *input) : env.Undefined();
+}
+
+template<typename T>
+Napi::Value toNAPI(const Napi::Env &env, const std::unique_ptr<T> &input) {
+  return input ? toNAPI(env, *input) : env.Undefined();
+}
+
+template<typename T>
+Napi::TypedArrayOf<T> toTypedArray(const Napi::Env &env, const std::vector<T> &input) {
+  Napi::TypedArrayOf<T> result = Napi::TypedArrayOf<T>::New(env, input.size());
+  std::copy(input.begin(), input.end(), result.Data());
+  return result;
+}
+
 template<typename ... Args>
 std::string format(const char *format, Args... args)
 {
@@ -32,47 +54,85 @@ std::string format(const char *format, Args... args)
 
 
 template<>
-Napi::Value toNAPI<std::string>(const Napi::Env &env, const std::string &input) {
+inline Napi::Value toNAPI<std::string>(const Napi::Env &env, const std::string &input) {
   return Napi::String::From(env, input);
 }
 
+template<>
+inline Napi::Value toNAPI<bool>(const Napi::Env &env, const bool &input) {
+  return Napi::Boolean::New(env, input);
+}
+
+template<>
+inline Napi::Value toNAPI<uint32_t>(const Napi::Env &env, const uint32_t &input) {
+  return Napi::Number::New(env, input);
+}
+
 template<typename T>
 std::vector<T> fromNAPIArr(const Napi::Value &info) {
   if (!info.IsArray()) {
     throw std::runtime_error("expected array");
   }
 
-  Napi::Object arr = info.ToObject();
+  Napi::Array arr = info.As<Napi::Array>();
+  uint32_t length = arr.Length();
 
   std::vector<T> res;
-  for (uint32_t i = 0; ; ++i) {
-    if (arr.Get(i).IsUndefined()) {
+  res.reserve(length);
+  for (uint32_t i = 0; i < length; ++i) {
+    Napi::Value item = arr.Get(i);
+    // a hole ends the list, as it always did
+    if (item.IsUndefined()) {
       break;
     }
-    res.push_back(fromNAPI<T>(arr.Get(i)));
+    res.push_back(fromNAPI<T>(item));
+  }
+  return res;
+}
+
+/**
+ * split a newline-separated list (as an alternative to passing large arrays of plugin names).
+ * Empty lines are skipped, a trailing \r on a line is removed
+ */
+inline std::vector<std::string> splitLines(const char *data, size_t length) {
+  std::vector<std::string> res;
+  res.reserve(std::count(data, data + length, '\n') + 1);
+
+  const char *end = data + length;
+  const char *lineStart = data;
+  while (lineStart < end) {
+    const char *lineEnd = std::find(lineStart, end, '\n');
+    const char *contentEnd = lineEnd;
+    if ((contentEnd > lineStart) && (*(contentEnd - 1) == '\r')) {
+      --contentEnd;
+    }
+    if (contentEnd > lineStart) {
+      res.emplace_back(lineStart, contentEnd);
+    }
+    lineStart = lineEnd + 1;
   }
   return res;
 }
 
 template<>
-std::string fromNAPI(const Napi::Value &info) {
+inline std::string fromNAPI(const Napi::Value &info) {
   return info.ToString().Utf8Value();
 }
 
 #ifdef _WIN32
 template<>
-std::wstring fromNAPI(const Napi::Value &info) {
+inline std::wstring fromNAPI(const Napi::Value &info) {
   return u8Tou16(info.ToString().Utf8Value());
 }
 #endif
 
 template<>
-int fromNAPI(const Napi::Value &info) {
+inline int fromNAPI(const Napi::Value &info) {
   return info.ToNumber().Int32Value();
 }
 
 template<>
-bool fromNAPI(const Napi::Value &info) {
+inline bool fromNAPI(const Napi::Value &info) {
   return info.ToBoolean();
 }
 
@@ -84,7 +144,7 @@ template<typename T> struct Tag {};
 template<typename T> void convertArg(Tag<T>, T &out, const Napi::CallbackInfo &info, int idx);
 
 template<>
-void convertArg<std::string>(Tag<std::string>, std::string &out, const Napi::CallbackInfo &info, int idx) {
+inline void convertArg<std::string>(Tag<std::string>, std::string &out, const Napi::CallbackInfo &info, int idx) {
   if (!info[idx].IsString()) {
     throw Napi::Error::New(info.Env(), format("parameter %d expected to be a string", idx + 1));
   }
@@ -92,7 +152,7 @@ void convertArg<std::string>(Tag<std::string>, std::string &out, const Napi::Cal
 }
 
 template<>
-void convertArg<std::wstring>(Tag<std::wstring>, std::wstring &out, const Napi::CallbackInfo &info, int idx) {
+inline void convertArg<std::wstring>(Tag<std::wstring>, std::wstring &out, const Napi::CallbackInfo &info, int idx) {
   if (!info[idx].IsString()) {
     throw Napi::Error::New(info.Env(), format("parameter %d expected to be a string", idx + 1));
   }
@@ -100,7 +160,7 @@ void convertArg<std::wstring>(Tag<std::wstring>, std::wstring &out, const Napi::
 }
 
 template<>
-void convertArg<bool>(Tag<bool>, bool &out, const Napi::CallbackInfo &info, int idx) {
+inline void convertArg<bool>(Tag<bool>, bool &out, const Napi::CallbackInfo &info, int idx) {
   if (!info[idx].IsBoolean()) {
     throw Napi::Error::New(info.Env(), format("parameter %d expected to be a boolean", idx + 1));
   }
@@ -108,7 +168,7 @@ void convertArg<bool>(Tag<bool>, bool &out, const Napi::CallbackInfo &info, int
 }
 
 template<>
-void convertArg<int>(Tag<int>, int &out, const Napi::CallbackInfo &info, int idx) {
+inline void convertArg<int>(Tag<int>, int &out, const Napi::CallbackInfo &info, int idx) {
   if (!info[idx].IsNumber()) {
     throw Napi::Error::New(info.Env(), format("parameter %d expected to be an integer", idx + 1));
   }
@@ -124,6 +184,24 @@ void convertArg(Tag<std::vector<T>>, std::vector<T> &out, const Napi::CallbackIn
   out = fromNAPIArr<T>(info[idx]);
 }
 
+/**
+ * lists of strings can also be passed as a single newline-separated string or as a utf-8 encoded
+ * Buffer of the same, which avoids one call into the javascript engine per element
+ */
+inline void convertArg(Tag<std::vector<std::string>>, std::vector<std::string> &out, const Napi::CallbackInfo &info, int idx) {
+  if (info[idx].IsString()) {
+    std::string joined = info[idx].As<Napi::String>().Utf8Value();
+    out = splitLines(joined.data(), joined.size());
+  } else if (info[idx].IsBuffer()) {
+    Napi::Buffer<char> buffer = info[idx].As<Napi::Buffer<char>>();
+    out = splitLines(buffer.Data(), buffer.Length());
+  } else if (info[idx].IsArray()) {
+    out = fromNAPIArr<std::string>(info[idx]);
+  } else {
+    throw Napi::Error::New(info.Env(), format("parameter %d expected to be an array", idx + 1));
+  }
+}
+
 template<size_t I = 0, typename T0, typename... TR>
 void convertRec(const Napi::CallbackInfo &info, int requiredCount, T0 &out, TR &... rest) {
   if ((requiredCount > I) || (info.Length() > I)) {
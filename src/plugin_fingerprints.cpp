@@ -0,0 +1,127 @@
+#include "plugin_fingerprints.h"
+#include <algorithm>
+#include <cctype>
+#include <set>
+
+static std::string toLowerKey(const std::string &input) {
+  std::string res(input);
+  std::transform(res.begin(), res.end(), res.begin(), [](unsigned char ch) { return std::tolower(ch); });
+  return res;
+}
+
+// plugins may be passed as paths, libloot identifies them by file name
+static std::string pluginKey(const std::string &plugin) {
+  return toLowerKey(reinterpret_cast<const char*>(std::filesystem::path(plugin).filename().u8string().c_str()));
+}
+
+PluginFingerprints::PluginFingerprints(loot::GameType gameType, const std::filesystem::path &gamePath)
+  : m_PluginsPath(gamePath / ((gameType == loot::GameType::tes3) ? "Data Files" : "Data"))
+{
+}
+
+std::filesystem::path PluginFingerprints::resolve(const loot::GameInterface &game, const std::string &plugin) const {
+  std::filesystem::path pluginPath(plugin);
+  if (pluginPath.is_absolute()) {
+    return pluginPath;
+  }
+
+  // additional data paths take precedence over the main one
+  std::error_code ec;
+  for (const auto &dataPath : game.GetAdditionalDataPaths()) {
+    std::filesystem::path candidate = dataPath / pluginPath;
+    if (std::filesystem::exists(candidate, ec)) {
+      return candidate;
+    }
+  }
+
+  std::filesystem::path res = m_PluginsPath / pluginPath;
+  if (!std::filesystem::exists(res, ec)) {
+    // ghosted plugins are loaded from <name>.ghost
+    std::filesystem::path ghosted = res;
+    ghosted += ".ghost";
+    if (std::filesystem::exists(ghosted, ec)) {
+      return ghosted;
+    }
+  }
+  return res;
+}
+
+std::optional<PluginFingerprints::Fingerprint> PluginFingerprints::fingerprint(const loot::GameInterface &game,
+                                                                               const std::string &plugin,
+                                                                               bool headersOnly) const {
+  std::filesystem::path filePath = resolve(game, plugin);
+  std::error_code ec;
+  uintmax_t size = std::filesystem::file_size(filePath, ec);
+  if (ec) {
+    return std::nullopt;
+  }
+  std::filesystem::file_time_type modified = std::filesystem::last_write_time(filePath, ec);
+  if (ec) {
+    return std::nullopt;
+  }
+  return Fingerprint{ size, modified, headersOnly };
+}
+
+IncrementalLoadResult PluginFingerprints::load(loot::GameInterface &game, const std::vector<std::string> &plugins,
+                                               bool headersOnly) {
+  IncrementalLoadResult res;
+
+  std::set<std::string> requested;
+  for (const auto &plugin : plugins) {
+    requested.insert(pluginKey(plugin));
+  }
+
+  std::set<std::string> loaded;
+  for (const auto &plugin : game.GetLoadedPlugins()) {
+    loaded.insert(toLowerKey(plugin->GetName()));
+  }
+
+  if (std::any_of(loaded.begin(), loaded.end(),
+                  [&requested](const std::string &key) { return requested.find(key) == requested.end(); })) {
+    game.ClearLoadedPlugins();
+    m_Loaded.clear();
+    loaded.clear();
+    res.reloadedAll = true;
+  }
+
+  std::vector<std::filesystem::path> changedPaths;
+  std::vector<std::pair<std::string, std::optional<Fingerprint>>> changed;
+  for (const auto &plugin : plugins) {
+    std::string key = pluginKey(plugin);
+    std::optional<Fingerprint> current = fingerprint(game, plugin, headersOnly);
+    auto iter = m_Loaded.find(key);
+    if (current.has_value()
+        && (iter != m_Loaded.end())
+        && (iter->second == *current)
+        && (loaded.find(key) != loaded.end())) {
+      ++res.unchanged;
+    } else {
+      changedPaths.push_back(std::filesystem::path(plugin));
+      changed.push_back({ key, current });
+      res.loaded.push_back(plugin);
+    }
+  }
+
+  if (changedPaths.empty()) {
+    return res;
+  }
+
+  // if loading fails we can't tell which of these plugins are loaded and in what state
+  for (const auto &iter : changed) {
+    m_Loaded.erase(iter.first);
+  }
+
+  game.LoadPlugins(changedPaths, headersOnly);
+
+  for (const auto &iter : changed) {
+    if (iter.second.has_value()) {
+      m_Loaded[iter.first] = *iter.second;
+    }
+  }
+
+  return res;
+}
+
+void PluginFingerprints::clear() {
+  m_Loaded.clear();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <loot/api.h>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * what an incremental loadPlugins call did
+ */
+struct IncrementalLoadResult {
+  // plugins that were parsed, in the order they were passed in
+  std::vector<std::string> loaded;
+  // number of plugins whose previously loaded data was kept
+  uint32_t unchanged{ 0 };
+  // set if plugins that were loaded before weren't in the list anymore. libloot can't unload individual
+  // plugins so everything had to be loaded from scratch
+  bool reloadedAll{ false };
+};
+
+/**
+ * remembers size and modification time of plugin files as they were when they got loaded, so a repeated
+ * loadPlugins call only has to parse the plugins that changed since
+ */
+class PluginFingerprints {
+public:
+
+  PluginFingerprints(loot::GameType gameType, const std::filesystem::path &gamePath);
+
+  /**
+   * load the plugins that aren't loaded yet or changed since they were loaded. Has to be the only way
+   * plugins get loaded into the game handle, otherwise call clear after loading
+   */
+  IncrementalLoadResult load(loot::GameInterface &game, const std::vector<std::string> &plugins, bool headersOnly);
+
+  // forget all fingerprints so the next incremental load parses everything
+  void clear();
+
+  // the game's main data directory
+  const std::filesystem::path &pluginsPath() const {
+    return m_PluginsPath;
+  }
+
+private:
+
+  struct Fingerprint {
+    uintmax_t size;
+    std::filesystem::file_time_type modified;
+    bool headersOnly;
+
+    bool operator==(const Fingerprint &rhs) const {
+      return (size == rhs.size) && (modified == rhs.modified) && (headersOnly == rhs.headersOnly);
+    }
+  };
+
+  // the file libloot would read for the plugin. Relative paths are resolved like libloot does it
+  std::filesystem::path resolve(const loot::GameInterface &game, const std::string &plugin) const;
+
+  // nullopt if the file can't be read, such a plugin is always passed to libloot which will report the error
+  std::optional<Fingerprint> fingerprint(const loot::GameInterface &game, const std::string &plugin, bool headersOnly) const;
+
+private:
+
+  std::filesystem::path m_PluginsPath;
+  // by lower case file name
+  std::map<std::string, Fingerprint> m_Loaded;
+
+};
@@ -0,0 +1,41 @@
+#include "property_keys.h"
+#include "addon_data.h"
+
+PropertyKeys::PropertyKeys(const Napi::Env &env) {
+  static const char *names[] = {
+#define LOOT_KEY_NAME(name) #name,
+    LOOT_PROPERTY_KEYS(LOOT_KEY_NAME)
+#undef LOOT_KEY_NAME
+  };
+
+  for (size_t i = 0; i < m_Keys.size(); ++i) {
+    m_Keys[i] = Napi::Persistent(Napi::String::New(env, names[i]));
+  }
+}
+
+const PropertyKeys &PropertyKeys::get(const Napi::Env &env) {
+  return env.GetInstanceData<AddonData>()->keys;
+}
+
+Napi::Object makeObject(const Napi::Env &env, std::initializer_list<std::pair<Key, napi_value>> properties) {
+  static const size_t MAX_PROPERTIES = 32;
+
+  if (properties.size() > MAX_PROPERTIES) {
+    throw Napi::Error::New(env, "too many properties");
+  }
+
+  const PropertyKeys &keys = PropertyKeys::get(env);
+
+  napi_property_descriptor descriptors[MAX_PROPERTIES];
+  size_t count = 0;
+  for (const auto &prop : properties) {
+    descriptors[count++] = { nullptr, keys[prop.first], nullptr, nullptr, nullptr, prop.second, napi_default_jsproperty, nullptr };
+  }
+
+  Napi::Object res = Napi::Object::New(env);
+  napi_status status = napi_define_properties(env, res, count, descriptors);
+  if (status != napi_ok) {
+    throw Napi::Error::New(env);
+  }
+  return res;
+}
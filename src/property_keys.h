@@ -0,0 +1,96 @@
+#pragma once
+
+#include <napi.h>
+#include <array>
+#include <initializer_list>
+#include <utility>
+
+// names of all properties on objects returned to javascript
+#define LOOT_PROPERTY_KEYS(X) \
+  X(afterGroups) \
+  X(bashTags) \
+  X(cleanInfo) \
+  X(cleaningUtility) \
+  X(condition) \
+  X(content) \
+  X(crc) \
+  X(deletedNavmeshCount) \
+  X(deletedReferenceCount) \
+  X(description) \
+  X(dirtyInfo) \
+  X(displayName) \
+  X(entries) \
+  X(flags) \
+  X(group) \
+  X(hash) \
+  X(headerVersion) \
+  X(hits) \
+  X(incompatibilities) \
+  X(isAddition) \
+  X(IsBlueprintPlugin) \
+  X(isEmpty) \
+  X(isLightPlugin) \
+  X(isMaster) \
+  X(IsMediumPlugin) \
+  X(IsUpdatePlugin) \
+  X(isValidAsLightPlugin) \
+  X(IsValidAsMediumPlugin) \
+  X(IsValidAsUpdatePlugin) \
+  X(itmCount) \
+  X(language) \
+  X(loadAfterFiles) \
+  X(loaded) \
+  X(loadsArchive) \
+  X(locations) \
+  X(masterlist) \
+  X(masterOffsets) \
+  X(masters) \
+  X(messages) \
+  X(misses) \
+  X(name) \
+  X(names) \
+  X(pluginCount) \
+  X(prelude) \
+  X(reloaded) \
+  X(reloadedAll) \
+  X(requirements) \
+  X(tags) \
+  X(text) \
+  X(type) \
+  X(typeOfEdgeToNextVertex) \
+  X(unchanged) \
+  X(url) \
+  X(userlist) \
+  X(version)
+
+enum class Key : size_t {
+#define LOOT_KEY_ENUM(name) name,
+  LOOT_PROPERTY_KEYS(LOOT_KEY_ENUM)
+#undef LOOT_KEY_ENUM
+  COUNT
+};
+
+/**
+ * persistent strings for all property names so they don't get created anew for every property
+ * of every object we return
+ */
+class PropertyKeys {
+public:
+  PropertyKeys(const Napi::Env &env);
+
+  // the key cache of the environment
+  static const PropertyKeys &get(const Napi::Env &env);
+
+  napi_value operator[](Key key) const {
+    return m_Keys[static_cast<size_t>(key)].Value();
+  }
+
+private:
+  std::array<Napi::Reference<Napi::String>, static_cast<size_t>(Key::COUNT)> m_Keys;
+};
+
+/**
+ * create an object with the given properties, in the given order. Objects created with the
+ * same sequence of keys share their hidden class
+ */
+Napi::Object makeObject(const Napi::Env &env, std::initializer_list<std::pair<Key, napi_value>> properties);
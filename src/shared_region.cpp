@@ -0,0 +1,182 @@
+#include "shared_region.h"
+#include "exceptions.h"
+#include "napi_helpers.h"
+#include "string_cast.h"
+#include <algorithm>
+#include <cstring>
+
+#ifndef WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // WIN32
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "counters in shared memory have to be lock-free");
+
+void SharedRegion::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(env, "SharedRegion", {
+    InstanceAccessor<&SharedRegion::getCapacity>("capacity"),
+    InstanceMethod("getCounter", &SharedRegion::getCounter),
+    InstanceMethod("setCounter", &SharedRegion::setCounter),
+    InstanceMethod("write", &SharedRegion::write),
+    InstanceMethod("read", &SharedRegion::read),
+    InstanceMethod("close", &SharedRegion::close),
+    });
+  exports.Set("SharedRegion", func);
+}
+
+SharedRegion::SharedRegion(const Napi::CallbackInfo &info)
+  : Napi::ObjectWrap<SharedRegion>(info)
+{
+  int size = 0;
+  unpackArgs(info, m_Name, size, m_Owner);
+
+  if (size <= static_cast<int>(HEADER_SIZE)) {
+    throw InvalidParameter(info.Env(), "SharedRegion", "size", std::to_string(size).c_str());
+  }
+  m_Size = static_cast<size_t>(size);
+
+#ifdef WIN32
+  std::wstring name = u8Tou16(m_Name);
+  if (m_Owner) {
+    m_Mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                   0, static_cast<DWORD>(m_Size), name.c_str());
+  } else {
+    m_Mapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+  }
+  if (m_Mapping == nullptr) {
+    throw ErrnoException(info.Env(), ::GetLastError(), "SharedRegion", m_Name.c_str());
+  }
+  m_View = static_cast<uint8_t*>(MapViewOfFile(m_Mapping, FILE_MAP_ALL_ACCESS, 0, 0, m_Size));
+  if (m_View == nullptr) {
+    unsigned long err = ::GetLastError();
+    release();
+    throw ErrnoException(info.Env(), err, "SharedRegion", m_Name.c_str());
+  }
+#else
+  m_FD = shm_open(m_Name.c_str(), m_Owner ? (O_CREAT | O_RDWR) : O_RDWR, 0600);
+  if (m_FD == -1) {
+    throw ErrnoException(info.Env(), errno, "SharedRegion", m_Name.c_str());
+  }
+  if (m_Owner) {
+    if (ftruncate(m_FD, static_cast<off_t>(m_Size)) == -1) {
+      int err = errno;
+      release();
+      throw ErrnoException(info.Env(), err, "SharedRegion", m_Name.c_str());
+    }
+  } else {
+    struct stat st;
+    if ((fstat(m_FD, &st) == -1) || (static_cast<size_t>(st.st_size) < m_Size)) {
+      int err = errno;
+      release();
+      throw ErrnoException(info.Env(), err, "SharedRegion", m_Name.c_str());
+    }
+  }
+  void *view = mmap(nullptr, m_Size, PROT_READ | PROT_WRITE, MAP_SHARED, m_FD, 0);
+  if (view == MAP_FAILED) {
+    int err = errno;
+    release();
+    throw ErrnoException(info.Env(), err, "SharedRegion", m_Name.c_str());
+  }
+  m_View = static_cast<uint8_t*>(view);
+#endif
+}
+
+SharedRegion::~SharedRegion() {
+  release();
+}
+
+void SharedRegion::release() {
+#ifdef WIN32
+  if (m_View != nullptr) {
+    UnmapViewOfFile(m_View);
+  }
+  if (m_Mapping != nullptr) {
+    CloseHandle(m_Mapping);
+    m_Mapping = nullptr;
+  }
+#else
+  if (m_View != nullptr) {
+    munmap(m_View, m_Size);
+  }
+  if (m_FD != -1) {
+    ::close(m_FD);
+    m_FD = -1;
+    // only the owner removes the name, when it releases the region. Processes that still have it mapped
+    // keep access. The name has to stay while the owner lives because a respawned peer opens it again,
+    // so if the owner crashes the entry (/dev/shm on linux) is left behind
+    if (m_Owner) {
+      shm_unlink(m_Name.c_str());
+    }
+  }
+#endif
+  m_View = nullptr;
+}
+
+std::atomic<uint64_t> &SharedRegion::counter(const Napi::Env &env, uint32_t index) const {
+  if (m_View == nullptr) {
+    throw Napi::Error::New(env, "shared region closed");
+  }
+  if (index >= COUNTER_COUNT) {
+    throw InvalidParameter(env, "counter", "index", std::to_string(index).c_str());
+  }
+  return reinterpret_cast<std::atomic<uint64_t>*>(m_View)[index];
+}
+
+void SharedRegion::checkRange(const Napi::Env &env, double position, double length) const {
+  if (m_View == nullptr) {
+    throw Napi::Error::New(env, "shared region closed");
+  }
+  if ((position < 0) || (length < 0) || (length > static_cast<double>(m_Size - HEADER_SIZE))) {
+    throw Napi::RangeError::New(env, "invalid range in shared region");
+  }
+}
+
+Napi::Value SharedRegion::getCapacity(const Napi::CallbackInfo &info) {
+  return Napi::Number::New(info.Env(), static_cast<double>(m_Size - HEADER_SIZE));
+}
+
+Napi::Value SharedRegion::getCounter(const Napi::CallbackInfo &info) {
+  uint32_t index = info[0].As<Napi::Number>().Uint32Value();
+  return Napi::Number::New(info.Env(),
+    static_cast<double>(counter(info.Env(), index).load(std::memory_order_acquire)));
+}
+
+void SharedRegion::setCounter(const Napi::CallbackInfo &info) {
+  uint32_t index = info[0].As<Napi::Number>().Uint32Value();
+  double value = info[1].As<Napi::Number>().DoubleValue();
+  counter(info.Env(), index).store(static_cast<uint64_t>(value), std::memory_order_release);
+}
+
+void SharedRegion::write(const Napi::CallbackInfo &info) {
+  double position = info[0].As<Napi::Number>().DoubleValue();
+  Napi::Buffer<uint8_t> buffer = info[1].As<Napi::Buffer<uint8_t>>();
+  checkRange(info.Env(), position, static_cast<double>(buffer.Length()));
+
+  const size_t capacity = m_Size - HEADER_SIZE;
+  const size_t offset = static_cast<size_t>(static_cast<uint64_t>(position) % capacity);
+  const size_t first = std::min(buffer.Length(), capacity - offset);
+  memcpy(data() + offset, buffer.Data(), first);
+  memcpy(data(), buffer.Data() + first, buffer.Length() - first);
+}
+
+Napi::Value SharedRegion::read(const Napi::CallbackInfo &info) {
+  double position = info[0].As<Napi::Number>().DoubleValue();
+  double length = info[1].As<Napi::Number>().DoubleValue();
+  checkRange(info.Env(), position, length);
+
+  const size_t capacity = m_Size - HEADER_SIZE;
+  const size_t offset = static_cast<size_t>(static_cast<uint64_t>(position) % capacity);
+  const size_t count = static_cast<size_t>(length);
+  const size_t first = std::min(count, capacity - offset);
+  Napi::Buffer<uint8_t> result = Napi::Buffer<uint8_t>::New(info.Env(), count);
+  memcpy(result.Data(), data() + offset, first);
+  memcpy(result.Data() + first, data(), count - first);
+  return result;
+}
+
+void SharedRegion::close(const Napi::CallbackInfo&) {
+  release();
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <napi.h>
+
+#ifdef WIN32
+#include <windows.h>
+#endif // WIN32
+
+/**
+ * named block of shared memory (file mapping on windows, posix shared memory elsewhere) used to
+ * pass large results from the LootAsync process to its host without pushing them through the pipe.
+ *
+ * The region starts with a small header of counters that both sides can update atomically, the
+ * remainder is used as a ring buffer: read and write take positions that increase monotonically
+ * and wrap around at the end of the data area.
+ * Data is always copied in and out, javascript never gets to see the mapped memory directly
+ * (electron doesn't allow buffers backed by external memory)
+ */
+class SharedRegion : public Napi::ObjectWrap<SharedRegion> {
+
+public:
+
+  static constexpr size_t COUNTER_COUNT = 8;
+  static constexpr size_t HEADER_SIZE = COUNTER_COUNT * sizeof(uint64_t);
+
+  static void Init(Napi::Env env, Napi::Object exports);
+
+  // (name: string, size: number, create: boolean)
+  SharedRegion(const Napi::CallbackInfo &info);
+  ~SharedRegion();
+
+  // size of the data area
+  Napi::Value getCapacity(const Napi::CallbackInfo &info);
+
+  // (index: number) => number
+  Napi::Value getCounter(const Napi::CallbackInfo &info);
+
+  // (index: number, value: number) => void
+  void setCounter(const Napi::CallbackInfo &info);
+
+  // (position: number, data: Buffer) => void
+  void write(const Napi::CallbackInfo &info);
+
+  // (position: number, length: number) => Buffer
+  Napi::Value read(const Napi::CallbackInfo &info);
+
+  void close(const Napi::CallbackInfo &info);
+
+private:
+
+  void release();
+
+  std::atomic<uint64_t> &counter(const Napi::Env &env, uint32_t index) const;
+
+  uint8_t *data() const {
+    return m_View + HEADER_SIZE;
+  }
+
+  void checkRange(const Napi::Env &env, double position, double length) const;
+
+private:
+
+  std::string m_Name;
+  bool m_Owner{ false };
+  size_t m_Size{ 0 };
+  uint8_t *m_View{ nullptr };
+#ifdef WIN32
+  HANDLE m_Mapping{ nullptr };
+#else
+  int m_FD{ -1 };
+#endif
+
+};
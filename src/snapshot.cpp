@@ -0,0 +1,67 @@
+#include "snapshot.h"
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <unordered_map>
+
+static std::string toLowerKey(const std::string &input) {
+  std::string res(input);
+  std::transform(res.begin(), res.end(), res.begin(), [](unsigned char ch) { return std::tolower(ch); });
+  return res;
+}
+
+PluginsSnapshot createPluginsSnapshot(const loot::GameInterface &game) {
+  std::vector<std::unique_ptr<const loot::PluginInterface>> plugins = game.GetLoadedPlugins();
+
+  PluginsSnapshot res;
+  res.pluginCount = static_cast<uint32_t>(plugins.size());
+  res.names.reserve(plugins.size());
+  res.flags.reserve(plugins.size());
+  res.crcs.reserve(plugins.size());
+  res.headerVersions.reserve(plugins.size());
+  res.versions.reserve(plugins.size());
+  res.masterOffsets.reserve(plugins.size() + 1);
+
+  // plugin file names are case insensitive
+  std::unordered_map<std::string, uint32_t> nameIndices;
+  for (const auto &plugin : plugins) {
+    nameIndices.emplace(toLowerKey(plugin->GetName()), static_cast<uint32_t>(res.names.size()));
+    res.names.push_back(plugin->GetName());
+  }
+
+  for (const auto &plugin : plugins) {
+    uint32_t flags = 0;
+    if (plugin->IsMaster()) flags |= PLUGIN_MASTER;
+    if (plugin->IsLightPlugin()) flags |= PLUGIN_LIGHT;
+    if (plugin->IsMediumPlugin()) flags |= PLUGIN_MEDIUM;
+    if (plugin->IsUpdatePlugin()) flags |= PLUGIN_UPDATE;
+    if (plugin->IsBlueprintPlugin()) flags |= PLUGIN_BLUEPRINT;
+    if (plugin->IsEmpty()) flags |= PLUGIN_EMPTY;
+    if (plugin->LoadsArchive()) flags |= PLUGIN_LOADS_ARCHIVE;
+    if (plugin->IsValidAsLightPlugin()) flags |= PLUGIN_VALID_AS_LIGHT;
+    if (plugin->IsValidAsMediumPlugin()) flags |= PLUGIN_VALID_AS_MEDIUM;
+    if (plugin->IsValidAsUpdatePlugin()) flags |= PLUGIN_VALID_AS_UPDATE;
+    if (game.IsPluginActive(plugin->GetName())) flags |= PLUGIN_ACTIVE;
+
+    auto crc = plugin->GetCRC();
+    if (crc.has_value()) {
+      flags |= PLUGIN_HAS_CRC;
+    }
+    res.flags.push_back(flags);
+    res.crcs.push_back(crc.value_or(0));
+    res.headerVersions.push_back(plugin->GetHeaderVersion().value_or(std::numeric_limits<float>::quiet_NaN()));
+    res.versions.push_back(plugin->GetVersion());
+
+    res.masterOffsets.push_back(static_cast<uint32_t>(res.masters.size()));
+    for (const auto &master : plugin->GetMasters()) {
+      auto iter = nameIndices.emplace(toLowerKey(master), static_cast<uint32_t>(res.names.size()));
+      if (iter.second) {
+        res.names.push_back(master);
+      }
+      res.masters.push_back(iter.first->second);
+    }
+  }
+  res.masterOffsets.push_back(static_cast<uint32_t>(res.masters.size()));
+
+  return res;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <loot/api.h>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * bits of the per-plugin flags in a PluginsSnapshot
+ */
+enum PluginFlag : uint32_t {
+  PLUGIN_MASTER = 1 << 0,
+  PLUGIN_LIGHT = 1 << 1,
+  PLUGIN_MEDIUM = 1 << 2,
+  PLUGIN_UPDATE = 1 << 3,
+  PLUGIN_BLUEPRINT = 1 << 4,
+  PLUGIN_EMPTY = 1 << 5,
+  PLUGIN_LOADS_ARCHIVE = 1 << 6,
+  PLUGIN_VALID_AS_LIGHT = 1 << 7,
+  PLUGIN_VALID_AS_MEDIUM = 1 << 8,
+  PLUGIN_VALID_AS_UPDATE = 1 << 9,
+  PLUGIN_ACTIVE = 1 << 10,
+  PLUGIN_HAS_CRC = 1 << 11,
+};
+
+/**
+ * struct-of-arrays view of all loaded plugins.
+ * names contains the loaded plugins first (pluginCount entries), followed by masters that are
+ * referenced but not loaded themselves. All other per-plugin arrays have pluginCount entries.
+ * The masters of plugin i are masters[masterOffsets[i]] to masters[masterOffsets[i + 1] - 1],
+ * each an index into names.
+ */
+struct PluginsSnapshot {
+  std::vector<std::string> names;
+  uint32_t pluginCount{ 0 };
+  std::vector<uint32_t> flags;
+  std::vector<uint32_t> crcs;
+  // NaN where the header version is unknown
+  std::vector<float> headerVersions;
+  std::vector<std::optional<std::string>> versions;
+  std::vector<uint32_t> masterOffsets;
+  std::vector<uint32_t> masters;
+};
+
+PluginsSnapshot createPluginsSnapshot(const loot::GameInterface &game);
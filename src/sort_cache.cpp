@@ -0,0 +1,177 @@
+#include "sort_cache.h"
+#include "file_hash.h"
+#include "loaded_lists.h"
+#include <loot/loot_version.h>
+#include <algorithm>
+#include <fstream>
+
+// number of results kept, each is only a few kilobytes
+static const size_t MAX_ENTRIES = 64;
+
+static const char *ENTRY_EXTENSION = ".sort";
+
+// increase when the content of the digest changes so older entries are ignored
+static const uint32_t DIGEST_VERSION = 1;
+
+void SortCache::setDirectory(const std::filesystem::path &directory) {
+  if (!directory.empty()) {
+    std::filesystem::create_directories(directory);
+  }
+  m_Directory = directory;
+}
+
+std::optional<std::string> SortCache::digest(const loot::GameInterface &game, const LoadedLists &lists,
+                                             const std::vector<std::string> &plugins) const {
+  std::optional<std::string> listsHash = lists.contentHash();
+  if (!listsHash.has_value()) {
+    return std::nullopt;
+  }
+
+  FNV1a hash;
+  auto updateInt = [&hash](uint32_t value) { hash.update(&value, sizeof(value)); };
+
+  updateInt(DIGEST_VERSION);
+  updateInt(loot::LIBLOOT_VERSION_MAJOR);
+  updateInt(loot::LIBLOOT_VERSION_MINOR);
+  updateInt(loot::LIBLOOT_VERSION_PATCH);
+  updateInt(static_cast<uint32_t>(game.GetType()));
+  hash.update(*listsHash);
+
+  std::vector<loot::Group> userGroups = game.GetDatabase().GetUserGroups();
+  updateInt(static_cast<uint32_t>(userGroups.size()));
+  for (const auto &group : userGroups) {
+    hash.update(group.GetName());
+    hash.update(group.GetDescription());
+    std::vector<std::string> afterGroups = group.GetAfterGroups();
+    updateInt(static_cast<uint32_t>(afterGroups.size()));
+    for (const auto &after : afterGroups) {
+      hash.update(after);
+    }
+  }
+
+  std::vector<std::string> loadOrder = game.GetLoadOrder();
+  updateInt(static_cast<uint32_t>(loadOrder.size()));
+  for (const auto &plugin : loadOrder) {
+    hash.update(plugin);
+  }
+
+  updateInt(static_cast<uint32_t>(plugins.size()));
+  for (const auto &name : plugins) {
+    std::unique_ptr<const loot::PluginInterface> plugin = game.GetPlugin(name);
+    // plugins loaded only with their headers have no crc so changes to them couldn't be detected
+    if ((plugin == nullptr) || !plugin->GetCRC().has_value()) {
+      return std::nullopt;
+    }
+    hash.update(name);
+    updateInt(*plugin->GetCRC());
+    updateInt((plugin->IsMaster() ? 1 : 0)
+            | (plugin->IsLightPlugin() ? 2 : 0)
+            | (plugin->IsMediumPlugin() ? 4 : 0)
+            | (plugin->IsUpdatePlugin() ? 8 : 0)
+            | (plugin->IsBlueprintPlugin() ? 16 : 0)
+            | (game.IsPluginActive(name) ? 32 : 0));
+    std::vector<std::string> masters = plugin->GetMasters();
+    updateInt(static_cast<uint32_t>(masters.size()));
+    for (const auto &master : masters) {
+      hash.update(master);
+    }
+  }
+
+  return hash.hex();
+}
+
+std::filesystem::path SortCache::entryPath(const std::string &digest) const {
+  return m_Directory / (digest + ENTRY_EXTENSION);
+}
+
+std::optional<std::vector<std::string>> SortCache::get(const std::string &digest,
+                                                       const std::vector<std::string> &plugins) const {
+  std::filesystem::path filePath = entryPath(digest);
+  std::ifstream file(filePath, std::ios::binary);
+  if (!file) {
+    return std::nullopt;
+  }
+
+  std::vector<std::string> res;
+  std::string line;
+  while (std::getline(file, line)) {
+    res.push_back(line);
+  }
+
+  // guard against hash collisions and damaged files, the result has to contain exactly the input plugins
+  std::vector<std::string> expected(plugins);
+  std::vector<std::string> actual(res);
+  std::sort(expected.begin(), expected.end());
+  std::sort(actual.begin(), actual.end());
+  if (expected != actual) {
+    return std::nullopt;
+  }
+
+  // the modification time tracks when an entry was last used
+  std::error_code ec;
+  std::filesystem::last_write_time(filePath, std::filesystem::file_time_type::clock::now(), ec);
+  return res;
+}
+
+void SortCache::put(const std::string &digest, const std::vector<std::string> &sorted) const {
+  std::filesystem::path filePath = entryPath(digest);
+  std::filesystem::path tempPath = filePath;
+  tempPath += ".tmp";
+
+  {
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    for (const auto &plugin : sorted) {
+      file << plugin << '\n';
+    }
+    if (!file) {
+      std::error_code ec;
+      std::filesystem::remove(tempPath, ec);
+      return;
+    }
+  }
+
+  // replaced in one step so other processes using the same directory never see a partial entry
+  std::error_code ec;
+  std::filesystem::rename(tempPath, filePath, ec);
+  if (ec) {
+    std::filesystem::remove(tempPath, ec);
+    return;
+  }
+  evict();
+}
+
+void SortCache::clear() const {
+  if (!enabled()) {
+    return;
+  }
+  std::error_code ec;
+  for (const auto &entry : std::filesystem::directory_iterator(m_Directory, ec)) {
+    if (entry.path().extension() == ENTRY_EXTENSION) {
+      std::error_code removeEc;
+      std::filesystem::remove(entry.path(), removeEc);
+    }
+  }
+}
+
+void SortCache::evict() const {
+  std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> entries;
+  std::error_code ec;
+  for (const auto &entry : std::filesystem::directory_iterator(m_Directory, ec)) {
+    if (entry.path().extension() == ENTRY_EXTENSION) {
+      std::error_code timeEc;
+      auto modified = entry.last_write_time(timeEc);
+      if (!timeEc) {
+        entries.emplace_back(modified, entry.path());
+      }
+    }
+  }
+
+  if (entries.size() <= MAX_ENTRIES) {
+    return;
+  }
+
+  std::sort(entries.begin(), entries.end());
+  for (size_t i = 0; i < entries.size() - MAX_ENTRIES; ++i) {
+    std::filesystem::remove(entries[i].second, ec);
+  }
+}
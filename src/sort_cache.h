@@ -0,0 +1,58 @@
+#pragma once
+
+#include <loot/api.h>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+class LoadedLists;
+
+/**
+ * stores sort results on disk so sorting the same plugins in the same state again (even in a different
+ * process) doesn't have to go through libloot.
+ * Results are keyed by a digest of everything libloot bases the sort on that is known here: the plugins and
+ * their content (crc), flags, masters and active state, the load order, the loaded lists and the user groups.
+ * Conditions in the metadata referring to files other than plugins aren't covered, the cache is cleared
+ * when the condition cache is cleared or files are reported as changed (invalidateConditionsForPaths)
+ */
+class SortCache {
+public:
+
+  /**
+   * directory to store the results in, created if necessary. An empty path disables the cache
+   */
+  void setDirectory(const std::filesystem::path &directory);
+
+  bool enabled() const {
+    return !m_Directory.empty();
+  }
+
+  /**
+   * nullopt if the state can't be determined reliably, e.g. if a plugin isn't fully loaded or the content
+   * of a list is unknown. Such a sort is neither looked up nor stored
+   */
+  std::optional<std::string> digest(const loot::GameInterface &game, const LoadedLists &lists,
+                                    const std::vector<std::string> &plugins) const;
+
+  // the stored result for the digest, if there is one and it's a valid order of the plugins
+  std::optional<std::vector<std::string>> get(const std::string &digest, const std::vector<std::string> &plugins) const;
+
+  // errors writing the cache are ignored, at worst the next sort isn't cached
+  void put(const std::string &digest, const std::vector<std::string> &sorted) const;
+
+  // remove all stored results, also those stored by other processes using the same directory
+  void clear() const;
+
+private:
+
+  std::filesystem::path entryPath(const std::string &digest) const;
+
+  // remove the least recently used entries beyond the limit
+  void evict() const;
+
+private:
+
+  std::filesystem::path m_Directory;
+
+};
@@ -0,0 +1,94 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+// libloot itself uses several threads for the heavy operations, this only has to help with lookups
+static const size_t MAX_THREADS = 7;
+
+ThreadPool &ThreadPool::instance() {
+  // never destroyed, the threads are idle when the process exits and joining them from a static
+  // destructor could block the exit
+  static ThreadPool *pool = new ThreadPool(
+    std::min<size_t>(MAX_THREADS, std::max(std::thread::hardware_concurrency(), 2u) - 1));
+  return *pool;
+}
+
+ThreadPool::ThreadPool(size_t threadCount) {
+  for (size_t i = 0; i < threadCount; ++i) {
+    m_Threads.emplace_back([this]() { run(); });
+    m_Threads.back().detach();
+  }
+}
+
+void ThreadPool::run() {
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_Wake.wait(lock, [this]() { return !m_Tasks.empty(); });
+      task = std::move(m_Tasks.front());
+      m_Tasks.pop_front();
+    }
+    task();
+  }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t minBatchSize,
+                             const std::function<void(size_t begin, size_t end)> &func) {
+  size_t batchCount = std::min((count + minBatchSize - 1) / minBatchSize, m_Threads.size() + 1);
+  if (batchCount <= 1) {
+    if (count > 0) {
+      func(0, count);
+    }
+    return;
+  }
+
+  size_t batchSize = (count + batchCount - 1) / batchCount;
+  batchCount = (count + batchSize - 1) / batchSize;
+
+  // helpers that only get to run after the caller finished all batches find nothing left to do
+  struct State {
+    std::atomic<size_t> next{ 0 };
+    size_t done{ 0 };
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable finished;
+  };
+  auto state = std::make_shared<State>();
+
+  auto work = [state, batchCount, batchSize, count, &func]() {
+    for (size_t batch = state->next++; batch < batchCount; batch = state->next++) {
+      std::exception_ptr error;
+      try {
+        func(batch * batchSize, std::min(count, (batch + 1) * batchSize));
+      } catch (...) {
+        error = std::current_exception();
+      }
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (error && !state->error) {
+        state->error = error;
+      }
+      if (++state->done == batchCount) {
+        state->finished.notify_all();
+      }
+    }
+  };
+
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (size_t i = 1; i < batchCount; ++i) {
+      m_Tasks.push_back(work);
+    }
+  }
+  m_Wake.notify_all();
+
+  work();
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->finished.wait(lock, [&]() { return state->done == batchCount; });
+  if (state->error) {
+    std::rethrow_exception(state->error);
+  }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * fixed set of threads shared by everything in the process, started on first use, so spreading work doesn't
+ * start new threads on every call
+ */
+class ThreadPool {
+public:
+
+  static ThreadPool &instance();
+
+  /**
+   * call func(begin, end) for batches of at least minBatchSize covering [0, count). Batches run on the pool
+   * and on the calling thread, which is why this works even if the pool is busy with other calls.
+   * Returns once all batches are done, rethrowing the first exception a batch threw
+   */
+  void parallelFor(size_t count, size_t minBatchSize, const std::function<void(size_t begin, size_t end)> &func);
+
+private:
+
+  explicit ThreadPool(size_t threadCount);
+
+  void run();
+
+private:
+
+  std::mutex m_Mutex;
+  std::condition_variable m_Wake;
+  std::deque<std::function<void()>> m_Tasks;
+  std::vector<std::thread> m_Threads;
+
+};
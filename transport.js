@@ -0,0 +1,253 @@
+const fs = require('fs');
+const net = require('net');
+const path = require('path');
+
+const { FrameDecoder, SHM_SIZE, SharedRing, decodeTypedArrays, encodeFrame, ipcPath, shmName,
+        writeFrame } = require('./ipc');
+
+/**
+ * Transports connect LootAsync to the code processing its requests (handler.js).
+ * They all provide the same interface:
+ *   open(callback) prepares the transport, has to be called (once) before anything else
+ *   spawn() starts a new remote, dropping the connection to a previous one
+ *   send(message, callback) sends a message to the current remote
+ *   close() releases the transport
+ * and report through the handlers passed to the constructor:
+ *   onMessage(message) for each message from the remote
+ *   onDisconnect(err) when the current remote went away. err is undefined if it simply ended
+ *   onError(message) for problems that don't affect the connection
+ */
+
+function generateId() {
+  const chars = 'abcdefghijklmnopqrstuvwxyz0123456789';
+  let res = [];
+  for (let i = 0; i < 8; ++i) {
+    res.push(chars[Math.floor(Math.random() * chars.length)]);
+  }
+  return res.join('');
+}
+
+// startup snapshot of async.js, created by build-snapshot.js
+const SNAPSHOT_PATH = path.join(__dirname, 'loot-async.blob');
+
+// identifies the node binary a snapshot was built with
+function snapshotInfo() {
+  return { version: process.version, arch: process.arch, platform: process.platform };
+}
+
+let snapshotArgsCache;
+
+/**
+ * node arguments that make the remote process start from the startup snapshot, empty if there is none
+ * or it can't be used by this binary
+ */
+function snapshotArgs() {
+  if (snapshotArgsCache === undefined) {
+    snapshotArgsCache = [];
+    try {
+      const info = JSON.parse(fs.readFileSync(`${SNAPSHOT_PATH}.json`, { encoding: 'utf8' }));
+      if ((process.versions.electron === undefined)
+          && (JSON.stringify(info) === JSON.stringify(snapshotInfo()))
+          && fs.existsSync(SNAPSHOT_PATH)) {
+        snapshotArgsCache = ['--snapshot-blob', SNAPSHOT_PATH];
+      }
+    } catch (err) {
+      // no snapshot
+    }
+  }
+  return snapshotArgsCache;
+}
+
+/**
+ * execArgv are arguments for node itself, they have to go before the script
+ */
+function defaultFork(script, args, execArgv = []) {
+  const cp = require('child_process');
+  return cp.spawn(process.execPath, [
+    ...execArgv,
+    script,
+    ...args,
+  ]);
+}
+
+/**
+ * runs the remote in a separate process (async.js), connected through a named pipe/unix socket.
+ * Most robust: A crash in libloot can't take down the host process
+ */
+class ProcessTransport {
+  constructor(id, onFork, handlers) {
+    this.id = id;
+    this.onFork = onFork;
+    this.handlers = handlers;
+    this.ipcPath = ipcPath(id);
+  }
+
+  open(callback) {
+    try {
+      const { SharedRegion } = require('./build/Release/node-loot');
+      // large messages from the remote are passed through shared memory. This is only an optimization,
+      // the pipe is used for everything if the region can't be created
+      this.ring = new SharedRing(new SharedRegion(shmName(this.id), SHM_SIZE, true));
+    } catch (err) {
+      this.ring = undefined;
+    }
+
+    this.ipc = new net.Server();
+    try {
+      if (process.platform !== 'win32') {
+        // a stale socket file would make listen fail
+        try {
+          fs.unlinkSync(this.ipcPath);
+        } catch (err) {
+          // nop
+        }
+      }
+      // this seems to fail for some users with EINVAL. why?
+      // May be a wine-only problem but that's not confirmed
+      this.ipc.listen(this.ipcPath, () => {
+        this.ipc.on('connection', socket => this.connect(socket));
+        callback(null);
+      })
+      .on('error', (err) => {
+        callback(err);
+      });
+    } catch (err) {
+      callback(new Error('failed to establish pipe'));
+    }
+  }
+
+  setHandlers(handlers) {
+    this.handlers = handlers;
+  }
+
+  spawn() {
+    this.socket = undefined;
+    this.process = this.onFork(`${__dirname}${path.sep}async.js`, [this.id], snapshotArgs());
+  }
+
+  send(message, callback) {
+    writeFrame(this.socket, encodeFrame(message), callback);
+  }
+
+  close() {
+    this.process = undefined;
+    // also removes the socket file on unix
+    this.ipc.close();
+    if (this.ring !== undefined) {
+      this.ring.close();
+      this.ring = undefined;
+    }
+  }
+
+  connect(socket) {
+    this.socket = socket;
+    const decoder = new FrameDecoder(frame => {
+      if (this.socket !== socket) {
+        // left over from a previous remote
+        return;
+      }
+      try {
+        let message = JSON.parse(frame.toString());
+        if (message.shm !== undefined) {
+          message = JSON.parse(this.ring.read(message.shm[0], message.shm[1]).toString());
+        }
+        message.result = decodeTypedArrays(message.result);
+        this.handlers.onMessage(message);
+      } catch (err) {
+        this.handlers.onError(err.message);
+      }
+    });
+    socket
+    .on('data', data => {
+      try {
+        decoder.push(data);
+      } catch (err) {
+        this.handlers.onError(err.message);
+      }
+    })
+    .on('error', err => {
+      this.handlers.onError(err.message);
+      if (this.socket === socket) {
+        this.handlers.onDisconnect(err);
+      }
+    })
+    .on('close', () => {
+      if (this.socket === socket) {
+        this.socket = undefined;
+        this.handlers.onDisconnect();
+      }
+    });
+  }
+}
+
+/**
+ * runs the remote in a worker thread (worker.js) of this process.
+ * Starts faster and needs less memory than a separate process, results are passed without
+ * serializing them to json and typed arrays are moved instead of copied.
+ * A crash in libloot will take down the whole process though
+ */
+class WorkerTransport {
+  constructor(handlers) {
+    this.handlers = handlers;
+  }
+
+  open(callback) {
+    callback(null);
+  }
+
+  setHandlers(handlers) {
+    this.handlers = handlers;
+  }
+
+  spawn() {
+    const { Worker } = require('worker_threads');
+
+    if (this.worker !== undefined) {
+      const previous = this.worker;
+      this.worker = undefined;
+      previous.terminate();
+    }
+
+    const worker = new Worker(path.join(__dirname, 'worker.js'));
+    worker
+    .on('message', message => {
+      if (this.worker === worker) {
+        this.handlers.onMessage(message);
+      }
+    })
+    .on('error', err => {
+      this.handlers.onError(err.message);
+    })
+    .on('exit', () => {
+      if (this.worker === worker) {
+        this.worker = undefined;
+        this.handlers.onDisconnect();
+      }
+    });
+    this.worker = worker;
+  }
+
+  send(message, callback) {
+    try {
+      this.worker.postMessage(message);
+      callback();
+    } catch (err) {
+      callback(err);
+    }
+  }
+
+  close() {
+    // the worker ends itself after handling the terminate request
+    this.worker = undefined;
+  }
+}
+
+module.exports = {
+  ProcessTransport,
+  SNAPSHOT_PATH,
+  WorkerTransport,
+  defaultFork,
+  generateId,
+  snapshotArgs,
+  snapshotInfo,
+};
@@ -0,0 +1,68 @@
+const fs = require('fs');
+const path = require('path');
+
+/**
+ * watches directories (usually the data directory of the game) for changed files so cached condition results
+ * referring to them can be invalidated, see LootAsync.watchConditionPaths.
+ * Changes are collected for options.delay milliseconds (default 500) and passed to onChange as absolute paths
+ * in one call. If the platform doesn't report which file changed, onChange receives null, meaning anything may
+ * have changed.
+ * Recursive watching requires Windows, macOS or node 20 or later on Linux
+ */
+class ConditionWatcher {
+  constructor(directories, onChange, options = {}) {
+    this.onChange = onChange;
+    this.delay = (options.delay !== undefined) ? options.delay : 500;
+    this.changed = new Set();
+    this.unknownChange = false;
+    this.timer = undefined;
+    this.watchers = [];
+    try {
+      directories.forEach(directory => {
+        const watcher = fs.watch(directory, { recursive: true, persistent: false }, (eventType, fileName) => {
+          if (fileName) {
+            this.changed.add(path.join(directory, fileName.toString()));
+          } else {
+            this.unknownChange = true;
+          }
+          this.schedule();
+        });
+        watcher.on('error', err => {
+          if (options.onError !== undefined) {
+            options.onError(err);
+          }
+        });
+        this.watchers.push(watcher);
+      });
+    } catch (err) {
+      this.close();
+      throw err;
+    }
+  }
+
+  close() {
+    this.watchers.forEach(watcher => watcher.close());
+    this.watchers = [];
+    if (this.timer !== undefined) {
+      clearTimeout(this.timer);
+      this.timer = undefined;
+    }
+  }
+
+  schedule() {
+    if (this.timer !== undefined) {
+      return;
+    }
+    this.timer = setTimeout(() => {
+      this.timer = undefined;
+      const paths = this.unknownChange ? null : Array.from(this.changed);
+      this.changed.clear();
+      this.unknownChange = false;
+      this.onChange(paths);
+    }, this.delay);
+  }
+}
+
+module.exports = {
+  ConditionWatcher,
+};
@@ -0,0 +1,40 @@
+const { parentPort } = require('worker_threads');
+
+const { createHandler } = require('./handler');
+
+/**
+ * postMessage uses the structured clone algorithm which, unlike JSON.stringify, ignores toJSON.
+ * Lazily converted objects (PluginMetadataHandle) have to be turned into plain objects first
+ */
+function toPlain(value) {
+  if ((value === null) || (typeof(value) !== 'object')) {
+    return value;
+  }
+  if (Array.isArray(value)) {
+    return value.some(item => (item !== null) && (typeof(item?.toJSON) === 'function'))
+      ? value.map(item => toPlain(item))
+      : value;
+  }
+  return (typeof(value.toJSON) === 'function') ? value.toJSON() : value;
+}
+
+function send(message) {
+  // typed arrays (as returned by getPluginsSnapshot) are moved to the receiving thread instead of being copied
+  const transfer = new Set();
+  if ((message.result !== undefined) && (message.result !== null) && (typeof(message.result) === 'object')) {
+    message.result = toPlain(message.result);
+    Object.values(message.result).forEach(value => {
+      if (ArrayBuffer.isView(value)) {
+        transfer.add(value.buffer);
+      }
+    });
+  }
+  parentPort.postMessage(message, Array.from(transfer));
+}
+
+const handleRequest = createHandler(send, () => process.exit(0));
+
+parentPort.on('message', handleRequest);
+
+// signal readiness to process messages
+send({ ready: true });